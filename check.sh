@@ -0,0 +1,134 @@
+#!/bin/bash
+#Regression checks run by "make check": every output path must match a
+#plain serial run of the same table, byte for byte
+BIN=$(pwd)/iau2wkt
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+failed=0
+
+check() {
+	if "$@"; then
+		echo "ok   $desc"
+	else
+		echo "FAIL $desc"
+		failed=1
+	fi
+}
+
+#Code lines of a WKT file as "code,WKT", comments dropped
+codes() {
+	grep -v '^#' "$1"
+}
+
+for year in 2000 2009; do
+	table=naifcodes_radii_m_wAsteroids_IAU$year.csv
+	ref=$TMP/ref$year.csv
+	$BIN $table $ref || { echo "FAIL IAU$year serial run"; exit 1; }
+
+	desc="IAU$year pipeline (-e $year - -)"
+	$BIN -e $year - - < $table > $TMP/pipe.csv
+	check cmp -s $ref $TMP/pipe.csv
+
+	desc="IAU$year dictionary expanded back (-d, -x)"
+	$BIN -d $TMP/$year.dict $table $TMP/dict.csv
+	$BIN -x $TMP/$year.dict $TMP/expanded.csv
+	check cmp -s $ref $TMP/expanded.csv
+
+	$BIN -r $TMP/$year.reg $table $TMP/reg.csv
+
+	#Every code looked up from the table, the registry file and the dictionary
+	requests=$(codes $ref | cut -d, -f1 | sed "s/^/-l IAU$year:/")
+	for source in $table $TMP/$year.reg $TMP/$year.dict; do
+		desc="IAU$year lookups from $(basename $source)"
+		$BIN $requests $source | paste -d, <(codes $ref | cut -d, -f1) - > $TMP/lookup.csv
+		check cmp -s <(codes $ref) $TMP/lookup.csv
+	done
+done
+
+#AUTO codes centered on request, from the three kinds of sources
+table=naifcodes_radii_m_wAsteroids_IAU2009.csv
+codes $TMP/ref2009.csv | cut -d, -f1 | grep '[6-8][0-9]$' \
+	| sed 's/^/IAU2009:/; s/$/,-120.5,30/' > $TMP/auto.txt
+for source in $table $TMP/2009.reg $TMP/2009.dict; do
+	$BIN -a $source < $TMP/auto.txt > $TMP/auto_$(basename $source).csv
+done
+desc="AUTO requests (-a) from the table resolve"
+check test $(grep -c . $TMP/auto_$table.csv) -eq $(wc -l < $TMP/auto.txt)
+desc="AUTO requests (-a) from the registry file equal the table's"
+check cmp -s $TMP/auto_$table.csv $TMP/auto_2009.reg.csv
+desc="AUTO requests (-a) from the dictionary equal the table's"
+check cmp -s $TMP/auto_$table.csv $TMP/auto_2009.dict.csv
+
+#A spliced definition against the plain one with its center values replaced
+#by name: Sinusoidal has no latitude to center, Lambert Conformal Conic and
+#Orthographic have one
+auto_expected() {
+	$BIN -l IAU2009:$1 $table | sed "s/\(\"$2\",\)[-0-9.]*\]/\1-120.5]/${3:+; s/\(\"$3\",\)[-0-9.]*\]/\130]/}"
+}
+for auto in "49960 Central_Meridian" "49970 Central_Meridian Latitude_Of_Origin" \
+	"49966 Longitude_Of_Center Latitude_Of_Center"; do
+	set -- $auto
+	desc="IAU2009:$1,-120.5,30 spliced as formatted"
+	check cmp -s <(auto_expected "$@") <($BIN -l IAU2009:$1,-120.5,30 $table)
+done
+desc="AUTO codes centered on their catalog values equal the plain ones"
+check cmp -s <($BIN -l IAU2009:49960 -l IAU2009:49970 $table) \
+	<($BIN -l IAU2009:49960,0,0 -l IAU2009:49970,0,0 $table)
+
+#Out of range, non AUTO, unknown and malformed requests
+for request in IAU2009:49960,361,0 IAU2009:49970,0,90.5 IAU2009:49970,0,-91 \
+	IAU2009:49910,0,0 IAU2009:49900,0,0 IAU2009:99999960,0,0 IAU2009:49960,0 IAU2009:49960,a,0; do
+	desc="$request fails (-l)"
+	$BIN -l $request $TMP/2009.reg > $TMP/auto_fail.txt 2>/dev/null
+	check test $? -ne 0 -a ! -s $TMP/auto_fail.txt
+	desc="$request fails (-a)"
+	echo $request | $BIN -a $TMP/2009.reg > $TMP/auto_fail.txt 2>/dev/null
+	check test $? -ne 0 -a "$(cat $TMP/auto_fail.txt)" = ""
+done
+
+desc="both epochs by 4 threads (-j 4)"
+$BIN -j 4 naifcodes_radii_m_wAsteroids_IAU2000.csv $TMP/j2000.csv \
+	naifcodes_radii_m_wAsteroids_IAU2009.csv $TMP/j2009.csv
+check cmp -s <(cat $TMP/ref2000.csv $TMP/ref2009.csv) <(cat $TMP/j2000.csv $TMP/j2009.csv)
+desc="threaded run from stdin to stdout (-j 2 -e 2009 - -)"
+$BIN -j 2 -e 2009 - - < naifcodes_radii_m_wAsteroids_IAU2009.csv > $TMP/pipe.csv
+check cmp -s $TMP/ref2009.csv $TMP/pipe.csv
+desc="threaded PROJ.4 output to stdout (-j 2 -p -)"
+$BIN -p - naifcodes_radii_m_wAsteroids_IAU2009.csv $TMP/p.csv > $TMP/serial.proj4
+(cd $TMP && $BIN -j 2 -p - $OLDPWD/naifcodes_radii_m_wAsteroids_IAU2009.csv p.csv > threaded.proj4)
+check cmp -s $TMP/serial.proj4 $TMP/threaded.proj4
+desc="errors and usage kept off stdout"
+{ echo IAU2009:49962,1,1 | $BIN -a $TMP/missing.csv; $BIN - - < /dev/null; $BIN; } > $TMP/stdout.txt 2>/dev/null
+check test ! -s $TMP/stdout.txt
+desc="no file named - written"
+check test ! -e $TMP/- -a ! -e ./-
+desc="threaded dictionary (-j 4 -d)"
+$BIN -j 4 -d $TMP/j2009.dict naifcodes_radii_m_wAsteroids_IAU2009.csv $TMP/j2009.csv
+check cmp -s $TMP/2009.dict $TMP/j2009.dict
+
+desc="vectorized latitudes within IAU_LAT_TOLERANCE of libm (bench)"
+$(dirname $BIN)/iau2wkt_bench 300 > /dev/null
+check test $? -eq 0
+
+#Incremental runs: first from scratch, then unchanged, then with Phobos'
+#mean radius (used by its triaxial definitions) edited. The year is given,
+#the temporary directory name would confuse the one from the file name
+cp naifcodes_radii_m_wAsteroids_IAU2009.csv $TMP/inc_IAU2009.csv
+desc="incremental first run (-i)"
+$BIN -e 2009 -i $TMP/inc.state $TMP/inc_IAU2009.csv $TMP/inc.csv > $TMP/changes.txt 2>/dev/null
+check cmp -s $TMP/ref2009.csv $TMP/inc.csv
+desc="incremental unchanged run lists no code"
+$BIN -e 2009 -i $TMP/inc.state $TMP/inc_IAU2009.csv $TMP/inc.csv > $TMP/changes.txt 2>/dev/null
+check test ! -s $TMP/changes.txt
+sed -i 's/^401,Phobos,11080.00,/401,Phobos,11090.00,/' $TMP/inc_IAU2009.csv
+$BIN -e 2009 $TMP/inc_IAU2009.csv $TMP/full.csv
+$BIN -e 2009 -i $TMP/inc.state $TMP/inc_IAU2009.csv $TMP/inc.csv > $TMP/changes.txt 2>/dev/null
+desc="incremental run with an edited row equals a full run"
+check cmp -s $TMP/full.csv $TMP/inc.csv
+desc="incremental run lists the edited body's codes"
+check test -s $TMP/changes.txt
+desc="incremental run lists exactly the changed codes"
+check cmp -s <(diff <(codes $TMP/ref2009.csv) <(codes $TMP/full.csv) | sed -n 's/^> \([0-9]*\),.*/IAU2009:\1 changed/p') \
+	$TMP/changes.txt
+
+exit $failed
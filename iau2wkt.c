@@ -1,6 +1,11 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include<unistd.h>
+#include<fcntl.h>
+#include<getopt.h>
+#include<time.h>
+#include "iauwkt.h"
 
 /*------------------------------------------------------------------------------
  *  Name: create_IAU2000_WKT_v2.py
@@ -33,326 +38,721 @@
 */
 
 void usage(){
-	printf("usage:\n\tiau2wkt naifcodes_radii_m_wAsteroids_IAU2000.csv outputFileName.wtk\n");
+	fprintf(stderr, "usage:\n\tiau2wkt [-r registryFileName] [-p projFileName] [-w wkt2FileName] [-J projjsonFileName] [-d dictFileName] naifcodes_radii_m_wAsteroids_IAU2000.csv outputFileName.wtk\n");
+	fprintf(stderr, "\tiau2wkt -i stateFileName naifcodes_radii_m_wAsteroids_IAU2000.csv outputFileName.wtk > changedCodes.txt\n");
+	fprintf(stderr, "\tiau2wkt -e 2009 - - < naifcodes_radii_m_wAsteroids_IAU2009.csv > outputFileName.wtk\n");
+	fprintf(stderr, "\tiau2wkt [-j threads] naifcodes_radii_m_wAsteroids_IAU2000.csv outputFileName.wtk [naifcodes_radii_m_wAsteroids_IAU2009.csv outputFileName.wtk ...]\n");
+	fprintf(stderr, "\tiau2wkt -l IAU2000:49915 [-l IAU2000:49962,lon,lat ...] naifcodes_radii_m_wAsteroids_IAU2000.csv|registryFileName [...]\n");
+	fprintf(stderr, "\tiau2wkt -x dictFileName outputFileName.wtk\n");
+	fprintf(stderr, "\tiau2wkt -a naifcodes_radii_m_wAsteroids_IAU2000.csv|registryFileName [...] < autoRequests.txt\n");
+	fprintf(stderr, "\tgenerating, --stats prints row, code, byte, time and heap counts to stderr,\n");
+	fprintf(stderr, "\t--stats-json statsFileName writes them as JSON\n");
 }
 
-const char* getfield(char* line, int num)
+#define OUTPUT_FLUSH_SIZE (1 << 20)
+
+static double now(void)
 {
-    const char* tok;
-    for (tok = strtok(line, ",");
-            tok && *tok;
-            tok = strtok(NULL, ",\n"))
-    {
-        if (!--num)
-            return tok;
-    }
-    return NULL;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
-int main(int argc, char * argv[])
+/*"-" names the standard input or output*/
+static int open_fd(const char * path, int output)
+{
+	if (strcmp(path, "-") == 0)
+		return output ? STDOUT_FILENO : STDIN_FILENO;
+	if (output)
+		return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	return open(path, O_RDONLY);
+}
+
+static void close_fd(int fd)
+{
+	if (fd != STDIN_FILENO && fd != STDOUT_FILENO)
+		close(fd);
+}
+
+/*open_fd for stdio streams*/
+static FILE * open_stream(const char * path, int output)
+{
+	if (strcmp(path, "-") == 0)
+		return output ? stdout : stdin;
+	return fopen(path, output ? "w" : "r");
+}
+
+/*Close a stream of open_stream, the standard ones are only flushed.
+ *Returns 0 on error*/
+static int close_stream(FILE * f)
+{
+	if (f == stdin)
+		return 1;
+	if (f == stdout)
+		return fflush(f) == 0;
+	return fclose(f) == 0;
+}
+
+/*Start the dictionary of -d, written aside and renamed over path by
+ *iau_dict_writer_close, or to stdout for "-"*/
+static int open_dict(IauDictWriter * dw, const char * path, int year)
 {
-	if(argc < 2) usage();
-	FILE * stream;
-	stream = fopen(argv[1],"r");
-		
+	if (strcmp(path, "-") == 0)
+		return iau_dict_writer_init(dw, stdout, year);
+	return iau_dict_writer_open(dw, path, year);
+}
+
+/*Optional outputs written besides the WKT1 file, NULL file names skip them*/
+enum {
+	EXTRA_PROJ4,
+	EXTRA_WKT2,
+	EXTRA_PROJJSON,
+	EXTRA_DICT,
+	EXTRA_COUNT
+};
+
+/*Write every code of every body of one table, and the extra formats of
+ *extra. Rows are written as they are read, output is flushed whenever the
+ *input has nothing more ready. Counts and stage times go to stats if not
+ *NULL*/
+static int generate(const char * input, const char * output, const char * const extra[], int theYear,
+	IauStats * stats)
+{
+	int in, out, fds[EXTRA_COUNT];
+	int status = EXIT_SUCCESS;
+	IauDictWriter dict;
+	int k;
+
 	/*grab year from file name*/
-	int theYear = 0;
-	char * pch;
-	pch = strtok(argv[1], "U.");
-		
-	int count=0;
-	while (pch != NULL)
-	{
-		if(count==1) theYear=atoi(pch);
-		pch = strtok(NULL, "U.");
-		count++;
-	}
+	if (!theYear)
+		theYear = iau_year_from_filename(input);
 	/*printf("theYear = %d\n",theYear);*/
 	/*Check if the Year has been found from filename*/
-	FILE *f1;
-	f1 = fopen(argv[2], "w") ;
-	
-	if ( theYear ){
-		/*Open output file for writing*/
-		fprintf(f1, "# IAU%i WKT Codes\n", theYear);
-	} else {
-		printf("Can't parse the year from filename: %s \n",argv[2]);	
+	if (!theYear) {
+		fprintf(stderr, "Can't parse the year from filename: %s, give it with -e \n",input);
 		usage();
-		exit(EXIT_FAILURE);
+		return(EXIT_FAILURE);
+	}
+	in = open_fd(input, 0);
+	if (in < 0) {
+		perror(input);
+		return(EXIT_FAILURE);
+	}
+	out = open_fd(output, 1);
+	if (out < 0) {
+		perror(output);
+		close_fd(in);
+		return(EXIT_FAILURE);
+	}
+	/*The dictionary goes through its own writer*/
+	for (k = 0; k < EXTRA_COUNT; k++) {
+		fds[k] = extra[k] && k != EXTRA_DICT ? open_fd(extra[k], 1) : -1;
+		if ((fds[k] < 0 && extra[k] && k != EXTRA_DICT)
+		|| (k == EXTRA_DICT && extra[k] && !open_dict(&dict, extra[k], theYear))) {
+			perror(extra[k]);
+			while (k--)
+				if (fds[k] >= 0)
+					close_fd(fds[k]);
+			close_fd(in);
+			close_fd(out);
+			return(EXIT_FAILURE);
+		}
 	}
-	/*Read input file line by line*/
-	char line[1024];
 
-	int theNaifNum = 0;
-	char * theTarget = NULL;
-	char * theMeanChar = NULL;
-	float theMean = 0.0, flattening = 0.0;
-	float theA = 0.0, theB = 0.0, theC = 0.0;
+	IauReader reader;
+	IauWriter f1, fx[EXTRA_COUNT];
+	IauBuf geogcs = {NULL, 0, 0, 0};
+	IauBuf ellps = {NULL, 0, 0, 0};
+	IauBuf datum = {NULL, 0, 0, 0};
+	IauBody body;
+	char * line;
+	int rowStatus;
+	double t0 = 0, t1 = 0;
+	iau_reader_init(&reader, in);
+	iau_writer_init(&f1, out, OUTPUT_FLUSH_SIZE);
+	for (k = 0; k < EXTRA_COUNT; k++)
+		iau_writer_init(&fx[k], fds[k], OUTPUT_FLUSH_SIZE);
+	iau_buf_printf(&f1.buf, "# IAU%i WKT Codes\n", theYear);
+	if (fds[EXTRA_WKT2] >= 0)
+		iau_buf_printf(&fx[EXTRA_WKT2].buf, "# IAU%i WKT2 Codes\n", theYear);
 	/*Start parsing line by line*/
-	while (fgets(line, 1024, stream))
+	for (;;)
 	{
-		/*Need to replace original line in tmp each time used*/
-		char* tmp = strdup(line);
-		/*printf("\nline is %s",line);*/
-		theNaifNum = atoi(getfield(tmp,1));
-		/*printf("NAIF: %d\n",theNaifNum);*/
-		tmp = strdup(line);
-		if(getfield(tmp,3) != NULL){
-			tmp = strdup(line);
-			theMeanChar = (char *) getfield(tmp,3);
-		} else {
-			theMeanChar = NULL;
-		}	
-		/*printf("MeanChar: %s\n",theMeanChar);*/
-		tmp = strdup(line);
-		if (theNaifNum != 0 && theMeanChar)/*#is it a number?*/
-		{ 
-			theTarget = (char *) getfield(tmp,2);
-			/*printf("Target: %s\t",theTarget);*/
-			tmp = strdup(line);
-			/*Check that third token in line is not empty*/
-			if (atof(getfield(tmp,3)) != 0)/*Then Radii values exist in input table*/
-			{ 
-				tmp = strdup(line);
-				theMean = atof(getfield(tmp,3));
-				tmp = strdup(line);
-				theA = atof(getfield(tmp,4));
-				tmp = strdup(line);
-				theB = atof(getfield(tmp,5));
-				tmp = strdup(line);
-				theC = atof(getfield(tmp,6));
-				/*printf("Mean: %f\t",theMean);*/
-				/*printf("A: %f\t",theA);*/
-				/*printf("B: %f\t",theB);*/
-				/*printf("C: %f\n",theC);*/
-				/*#Check to see if the Mean should be used, for triaxial bodies*/
-				if ((theA != theB) && (theA != theC))
-				{
-					theA = theMean;
-					theC = theMean;
-				}
-				flattening = ((theA - theC) / theA);
-				if (flattening < 0.0000000001 
-				&& flattening > -0.0000000001
-				&& flattening != 0.0)
-				{
-					/*Inverse flattening if too small*/
-					flattening = 1.0 / flattening;
-				}
-				/*Even = Areocentric*/
-				/*Odd = Areographic*/
-
-				/*GEOIDS*/
-				fprintf(f1, "# IAU%d WKT Codes for %s\n", theYear, theTarget);
-	
-				int gisCode = theNaifNum * 100;
-
-					fprintf(f1,"# GEOGCS %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 1;
-
-					fprintf(f1,"# GEOGCS %s Areographic\n", theTarget);
-				fprintf(f1, "%d,GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				/*#Static Projections*/
-				gisCode = theNaifNum * 100 + 10; /*# Equirectangular, ocentric, clon=0*/
-
-					fprintf(f1,"# Equirectangular %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1,"%d,PROJCS[\"%s_Equidistant_Cylindrical\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Equirectangular\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 11; /*# Equirectangular, ographic, clon=0*/
-
-					fprintf(f1,"# Equirectangular %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Equidistant_Cylindrical\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Equirectangular\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 12; /*# Equirectangular, ocentric, clon=180*/
-
-					fprintf(f1,"# Equirectangular %s Areocentric, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Equidistant_Cylindrical\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Equirectangular\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 13; /*# Equirectangular, ographic, clon=180*/
-
-					fprintf(f1,"# Equirectangular %s Areographic, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Equidistant_Cylindrical\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Equirectangular\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 14; /*# Sinusoidal, ocentric, clon=0*/
-
-					fprintf(f1,"# Sinusoidal %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Sinusoidal\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Sinusoidal\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 15; /*# Sinusoidal, ographic, clon=0*/
-
-					fprintf(f1,"# Sinusoidal %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Sinusoidal\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Sinusoidal\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 16; /*# Sinusoidal, ocentric, clon=180*/
-
-					fprintf(f1,"# Sinusoidal %s Areocentric, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Sinusoidal\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Sinusoidal\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 17; /*# Sinusoidal, ographic, clon=180*/
-
-					fprintf(f1,"# Sinusoidal %s Areographic, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Sinusoidal\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Sinusoidal\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 18; /*# North Polar, ocentric, clon=0*/
-
-					fprintf(f1,"# North Polar %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_North_Pole_Stereographic\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Stereographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",1],PARAMETER[\"Latitude_Of_Origin\",90],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 19; /*# North Polar, ographic, clon=0*/
-
-					fprintf(f1,"# North Polar %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_North_Pole_Stereographic\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Stereographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",1],PARAMETER[\"Latitude_Of_Origin\",90],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 20; /*# South Polar, ocentric, clon=0*/
-
-					fprintf(f1,"# South Polar %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_South_Pole_Stereographic\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Stereographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",1],PARAMETER[\"Latitude_Of_Origin\",-90],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 21; /*# South Polar, ographic, clon=0*/
-
-					fprintf(f1,"# South Polar %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_South_Pole_Stereographic\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Stereographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",1],PARAMETER[\"Latitude_Of_Origin\",-90],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 22; /*# Mollweide, ocentric, clon=0*/
-
-					fprintf(f1,"# Mollweide %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mollweide\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mollweide\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 23; /*# Mollweide, ographic, clon=0*/
-
-					fprintf(f1,"# Mollweide %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mollweide\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mollweide\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 24; /*# Mollweide, ocentric, clon=180*/
-
-					fprintf(f1,"# Mollweide %s Areocentric, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mollweide\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mollweide\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 25; /*# Mollweide, ocentric, clon=180*/
-
-					fprintf(f1,"# Mollweide %s Areographic, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mollweide\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mollweide\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 26; /*# Robinson, ocentric, clon=0*/
-
-					fprintf(f1,"# Robinson %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Robinson\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Robinson\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 27; /*# Robinson, ographic, clon=0*/
-
-					fprintf(f1,"# Robinson %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Robinson\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Robinson\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 28; /*# Robinson, ocentric, clon=180*/
-
-					fprintf(f1,"# Robinson %s Areocentric, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Robinson\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Robinson\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 29; /*# Robinson, ographic, clon=180*/
-
-					fprintf(f1,"# Robinson %s Areographic, clon=180\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Robinson\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Robinson\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",180],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				/*#AUTO Projections*/
-				gisCode = theNaifNum * 100 + 60; /*# Sinusoidal, ocentric*/
-
-					fprintf(f1,"# Sinusoidal AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Sinusoidal_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Sinusoidal\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 61; /*# Sinusoidal, ographic*/
-
-					fprintf(f1,"# Sinusoidal AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Sinusoidal_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Sinusoidal\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 62; /*# Stereographic, ocentric, clon=0*/
-
-					fprintf(f1,"# Stereographic AUTO %s Areocentric, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Stereographic_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Stereographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",1],PARAMETER[\"Latitude_Of_Origin\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 63; /*# Stereographic, ographic, clon=0*/
-
-					fprintf(f1,"# Stereographic AUTO %s Areographic, clon=0\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Stereographic_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Stereographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",1],PARAMETER[\"Latitude_Of_Origin\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 64; /*# Transverse Mercator, ocentric*/
-
-					fprintf(f1,"# Transverse Mercator AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Transverse_Mercator_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Transverse_Mercator\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",0.9996],PARAMETER[\"Latitude_Of_Origin\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 65; /*# Transverse Mercator, ographic*/
-
-					fprintf(f1,"# Transverse Mercator AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Transverse_Mercator_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Transverse_Mercator\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Scale_Factor\",0.9996],PARAMETER[\"Latitude_Of_Origin\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 66; /*# Orthographic, ocentric*/
-
-					fprintf(f1,"# Orthographic AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Orthographic_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Orthographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Longitude_Of_Center\",0.0],PARAMETER[\"Latitude_Of_Center\",90.0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 67; /*# Orthographic, ographic*/
-
-					fprintf(f1,"# Orthographic AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Orthographic_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Orthographic\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Longitude_Of_Center\",0.0],PARAMETER[\"Latitude_Of_Center\",90.0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 68; /*# Equidistant_Cylindrical, ocentric*/
-
-					fprintf(f1,"# Equidistant Cylindrical AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Equidistant_Cylindrical_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Equirectangular\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 69; /*# Equidistant_Cylindrical, ographic*/
-
-					fprintf(f1,"# Equidistant Cylindrical AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Equidistant_Cylindrical_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Equirectangular\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 70; /*# Lambert_Conformal_Conic, ocentric*/
-
-					fprintf(f1,"# Lambert Conformal Conic AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Lambert_Conformal_Conic_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Lambert_Conformal_Conic_2SP\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",-20],PARAMETER[\"Standard_Parallel_2\",20],PARAMETER[\"Latitude_Of_Origin\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 71; /*# Lambert_Conformal_Conic, ographic*/
-
-					fprintf(f1,"# Lambert Conformal Conic AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Lambert_Conformal_Conic_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Lambert_Conformal_Conic_2SP\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",-20],PARAMETER[\"Standard_Parallel_2\",20],PARAMETER[\"Latitude_Of_Origin\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 72; /*# Lambert_Azimuthal_Equal_Area, ocentric*/
-
-					fprintf(f1,"# Lambert Azimuthal Equal Area AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Lambert_Azimuthal_Equal_Area_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Lambert_Azimuthal_Equal_Area\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Latitude_Of_Origin\",90],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 73; /*# Lambert_Azimuthal_Equal_Area, ographic*/
-
-					fprintf(f1,"# Lambert Azimuthal Equal Area AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Lambert_Azimuthal_Equal_Area_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Lambert_Azimuthal_Equal_Area\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Latitude_Of_Origin\",90],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 74; /*# Mercator, ocentric*/
-
-					fprintf(f1,"# Mercator AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mercator_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mercator_1SP\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 75; /*# Mercator, ographic*/
-
-					fprintf(f1,"# Mercator AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mercator_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mercator_1SP\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],PARAMETER[\"Standard_Parallel_1\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 76; /*# Albers, ocentric*/
-
-					fprintf(f1,"# Albers AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Albers_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Albers_Conic_Equal_Area\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0.0],PARAMETER[\"Standard_Parallel_1\",60.0],PARAMETER[\"Standard_Parallel_2\",20.0],PARAMETER[\"Latitude_Of_Origin\",40.0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 77; /*# Albers, ographic*/
-
-					fprintf(f1,"# Albers AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Albers_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Albers_Conic_Equal_Area\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0.0],PARAMETER[\"Standard_Parallel_1\",60.0],PARAMETER[\"Standard_Parallel_2\",20.0],PARAMETER[\"Latitude_Of_Origin\",40.0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 78; /*# Oblique Cylindrical Equal Area, ocentric*/
-
-					fprintf(f1,"# Oblique Cylindrical Equal Area AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Oblique_Cylindrical_Equal_Area_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Oblique_Cylindrical_Equal_Area\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0.0],PARAMETER[\"Standard_Parallel_1\",0.0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 79; /*# Oblique Cylindrical Equal Area, ographic*/
-
-					fprintf(f1,"# Oblique Cylindrical Equal Area AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Oblique_Cylindrical_Equal_Area_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Oblique_Cylindrical_Equal_Area\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0.0],PARAMETER[\"Standard_Parallel_1\",0.0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 80; /*# Mollweide, ocentric*/
-
-					fprintf(f1,"# Mollweide AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mollweide_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mollweide\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 81; /*# Mollweide, ographic*/
-
-					fprintf(f1,"# Mollweide AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Mollweide_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Mollweide\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-	
-				gisCode = theNaifNum * 100 + 82; /*# Robinson, ocentric*/
-
-					fprintf(f1,"# Robinson AUTO %s Areocentric\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Robinson_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Robinson\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
-				gisCode = theNaifNum * 100 + 83; /*# Robinson, ographic*/
-
-					fprintf(f1,"# Robinson AUTO %s Areographic\n", theTarget);
-				fprintf(f1, "%d,PROJCS[\"%s_Robinson_AUTO\",GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]],PROJECTION[\"Robinson\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"Central_Meridian\",0],UNIT[\"Meter\",1],AUTHORITY[\"IAU%d\",\"%d\"]]\n",gisCode,theTarget,theTarget,theYear,theTarget,theYear,theTarget,theYear,theA,flattening,theYear,gisCode);
+		if (stats)
+			t0 = now();
+		if (iau_reader_would_block(&reader)) {
+			iau_writer_flush(&f1);
+			for (k = 0; k < EXTRA_COUNT; k++)
+				if (fds[k] >= 0)
+					iau_writer_flush(&fx[k]);
+			if (extra[EXTRA_DICT])
+				fflush(dict.stream);
+			if (stats) {
+				t1 = now();
+				stats->seconds[IAU_STAGE_WRITE] += t1 - t0;
+				t0 = t1;
+			}
+		}
+		line = iau_reader_line(&reader);
+		if (!line)
+			break;
+		rowStatus = iau_parse_row_status(line, &body);
+		if (stats) {
+			stats->rows[rowStatus]++;
+			t1 = now();
+			stats->seconds[IAU_STAGE_PARSE] += t1 - t0;
+			t0 = t1;
+		}
+		if (rowStatus != IAU_ROW_OK)
+			continue;
+		iau_format_body(&f1.buf, &geogcs, &body, theYear);
+		if (fds[EXTRA_PROJ4] >= 0)
+			iau_format_body_proj4(&fx[EXTRA_PROJ4].buf, &ellps, &body);
+		if (fds[EXTRA_WKT2] >= 0)
+			iau_format_body_wkt2(&fx[EXTRA_WKT2].buf, &datum, &body, theYear);
+		if (fds[EXTRA_PROJJSON] >= 0)
+			iau_format_body_projjson(&fx[EXTRA_PROJJSON].buf, &datum, &body, theYear);
+		if (stats) {
+			stats->bodies++;
+			stats->triaxial += iau_body_triaxial(&body);
+			t1 = now();
+			stats->seconds[IAU_STAGE_FORMAT] += t1 - t0;
+			t0 = t1;
+		}
+		iau_writer_commit(&f1);
+		for (k = 0; k < EXTRA_COUNT; k++)
+			if (fds[k] >= 0)
+				iau_writer_commit(&fx[k]);
+		if (extra[EXTRA_DICT])
+			iau_dict_writer_add(&dict, &body);
+		if (stats)
+			stats->seconds[IAU_STAGE_WRITE] += now() - t0;
+	}
+	if (stats) {
+		t1 = now();
+		stats->seconds[IAU_STAGE_PARSE] += t1 - t0;
+		t0 = t1;
+	}
+	if (reader.error) {
+		perror(input);
+		status = EXIT_FAILURE;
+	}
+	if (!iau_writer_close(&f1)) {
+		perror(output);
+		status = EXIT_FAILURE;
+	}
+	for (k = 0; k < EXTRA_COUNT; k++) {
+		if (fds[k] < 0)
+			continue;
+		if (!iau_writer_close(&fx[k])) {
+			perror(extra[k]);
+			status = EXIT_FAILURE;
+		}
+		close_fd(fds[k]);
+	}
+	if (extra[EXTRA_DICT]) {
+		if (stats)
+			stats->bytes += dict.written;
+		if (!iau_dict_writer_close(&dict, status == EXIT_SUCCESS)) {
+			if (status == EXIT_SUCCESS)
+				perror(extra[EXTRA_DICT]);
+			status = EXIT_FAILURE;
+		}
+	}
+	if (stats) {
+		stats->seconds[IAU_STAGE_WRITE] += now() - t0;
+		stats->bytes += f1.written;
+		for (k = 0; k < EXTRA_COUNT; k++)
+			stats->bytes += fx[k].written;
+	}
+	iau_reader_free(&reader);
+	iau_buf_free(&geogcs);
+	iau_buf_free(&ellps);
+	iau_buf_free(&datum);
+	close_fd(in);
+	close_fd(out);
+	return status;
+}
+
+/*Regenerate only the bodies whose row changed since the last run with the
+ *same state file, listing the codes that changed*/
+static int update(const char * input, const char * output, const char * state, int theYear)
+{
+	IauUpdateStats stats;
+	int in, ok;
+
+	if (!theYear)
+		theYear = iau_year_from_filename(input);
+	if (!theYear) {
+		fprintf(stderr, "Can't parse the year from filename: %s, give it with -e \n",input);
+		usage();
+		return(EXIT_FAILURE);
+	}
+	in = open_fd(input, 0);
+	if (in < 0) {
+		perror(input);
+		return(EXIT_FAILURE);
+	}
+	ok = iau_update(in, theYear, output, state, stdout, &stats);
+	close_fd(in);
+	if (!ok) {
+		perror(output);
+		return(EXIT_FAILURE);
+	}
+	fprintf(stderr, "%lu bodies, %lu rebuilt, %lu codes added, %lu changed, %lu removed\n",
+		(unsigned long)stats.bodies, (unsigned long)stats.rebuilt, (unsigned long)stats.codesAdded,
+		(unsigned long)stats.codesChanged, (unsigned long)stats.codesRemoved);
+	return(EXIT_SUCCESS);
+}
+
+/*Write the binary registry of a table for mmap based lookups*/
+static int write_registry(const char * input, const char * registry, int year)
+{
+	IauRegistry * reg = iau_registry_load(input, year);
+
+	if (!reg) {
+		fprintf(stderr, "Can't load table: %s \n", input);
+		return(EXIT_FAILURE);
+	}
+	if (!iau_registry_write_map(reg, registry)) {
+		perror(registry);
+		iau_registry_free(reg);
+		return(EXIT_FAILURE);
+	}
+	iau_registry_free(reg);
+	return(EXIT_SUCCESS);
+}
+
+/*Write several tables at once, bodies formatted by nThreads workers.
+ *pairs holds nPairs input table and output file names*/
+static int generate_batches(char * const pairs[], int nPairs, int nThreads,
+	const char * const extra[], const char * registry, int year, IauStats * stats)
+{
+	IauBatch * batches = calloc(nPairs, sizeof(IauBatch));
+	IauDictWriter dict;
+	int i, n, status = EXIT_FAILURE;
+
+	if (!batches) {
+		perror("calloc");
+		return(EXIT_FAILURE);
+	}
+	for (i = 0; i < nPairs; i++) {
+		const char * input = pairs[2 * i];
+		const char * output = pairs[2 * i + 1];
+		int theYear = year ? year : iau_year_from_filename(input);
+		if (!theYear) {
+			fprintf(stderr, "Can't parse the year from filename: %s, give it with -e \n",input);
+			usage();
+			goto done;
+		}
+		double t0 = now();
+		FILE * in = open_stream(input, 0);
+		if (!in) {
+			perror(input);
+			goto done;
+		}
+		IauRegistry * reg = iau_registry_read(in, theYear);
+		close_stream(in);
+		if (!reg) {
+			fprintf(stderr, "Can't load table: %s \n", input);
+			goto done;
+		}
+		if (stats) {
+			stats->seconds[IAU_STAGE_PARSE] += now() - t0;
+			iau_registry_stats(reg, stats);
+		}
+		batches[i].reg = reg;
+		batches[i].wkt = open_stream(output, 1);
+		if (!batches[i].wkt) {
+			perror(output);
+			goto done;
+		}
+		n = fprintf(batches[i].wkt, "# IAU%i WKT Codes\n", theYear);
+		if (stats && n > 0)
+			stats->bytes += n;
+		if (extra[EXTRA_PROJ4]) {
+			batches[i].proj4 = open_stream(extra[EXTRA_PROJ4], 1);
+			if (!batches[i].proj4) {
+				perror(extra[EXTRA_PROJ4]);
+				goto done;
+			}
+		}
+		if (extra[EXTRA_WKT2]) {
+			batches[i].wkt2 = open_stream(extra[EXTRA_WKT2], 1);
+			if (!batches[i].wkt2) {
+				perror(extra[EXTRA_WKT2]);
+				goto done;
 			}
+			n = fprintf(batches[i].wkt2, "# IAU%i WKT2 Codes\n", theYear);
+			if (stats && n > 0)
+				stats->bytes += n;
 		}
-		free(tmp);
+		if (extra[EXTRA_PROJJSON]) {
+			batches[i].projjson = open_stream(extra[EXTRA_PROJJSON], 1);
+			if (!batches[i].projjson) {
+				perror(extra[EXTRA_PROJJSON]);
+				goto done;
+			}
+		}
+		if (extra[EXTRA_DICT]) {
+			/*Extra outputs come with a single table*/
+			if (!open_dict(&dict, extra[EXTRA_DICT], theYear)) {
+				perror(extra[EXTRA_DICT]);
+				goto done;
+			}
+			batches[i].dict = dict.stream;
+			if (stats)
+				stats->bytes += dict.written;
+		}
+	}
+	if (!iau_write_batches_stats(batches, nPairs, nThreads, stats)) {
+		perror("write");
+		goto done;
+	}
+	if (registry && !iau_registry_write_map(batches[0].reg, registry)) {
+		perror(registry);
+		goto done;
+	}
+	status = EXIT_SUCCESS;
+
+done:
+	for (i = 0; i < nPairs; i++) {
+		if (batches[i].wkt && !close_stream(batches[i].wkt))
+			status = EXIT_FAILURE;
+		if (batches[i].proj4 && !close_stream(batches[i].proj4))
+			status = EXIT_FAILURE;
+		if (batches[i].wkt2 && !close_stream(batches[i].wkt2))
+			status = EXIT_FAILURE;
+		if (batches[i].projjson && !close_stream(batches[i].projjson))
+			status = EXIT_FAILURE;
+		if (batches[i].dict && !iau_dict_writer_close(&dict, status == EXIT_SUCCESS)) {
+			if (status == EXIT_SUCCESS)
+				perror(extra[EXTRA_DICT]);
+			status = EXIT_FAILURE;
+		}
+		iau_registry_free((IauRegistry *)batches[i].reg);
+	}
+	free(batches);
+	return status;
+}
+
+/*Write the full WKT file of a dictionary*/
+static int expand_dict(const char * input, const char * output)
+{
+	IauDict * dict = iau_dict_open(input);
+	IauWriter w;
+	size_t i;
+	int out, status = EXIT_SUCCESS;
+
+	if (!dict) {
+		fprintf(stderr, "Can't load dictionary: %s \n", input);
+		return(EXIT_FAILURE);
+	}
+	out = open_fd(output, 1);
+	if (out < 0) {
+		perror(output);
+		iau_dict_close(dict);
+		return(EXIT_FAILURE);
+	}
+	iau_writer_init(&w, out, OUTPUT_FLUSH_SIZE);
+	iau_buf_printf(&w.buf, "# IAU%i WKT Codes\n", iau_dict_year(dict));
+	for (i = 0; i < iau_dict_count(dict); i++) {
+		iau_dict_expand_body(dict, &w.buf, i);
+		iau_writer_commit(&w);
+	}
+	if (!iau_writer_close(&w)) {
+		perror(output);
+		status = EXIT_FAILURE;
+	}
+	close_fd(out);
+	iau_dict_close(dict);
+	return status;
+}
+
+/*Load tables, registry files, dictionaries or NAIF tables, into a new lookup*/
+static IauLookup * load_lookup(char * const tables[], int nTables)
+{
+	IauLookup * lk = iau_lookup_new(256);
+	int i;
+
+	if (!lk) {
+		perror("iau_lookup_new");
+		return NULL;
+	}
+	for (i = 0; i < nTables; i++) {
+		IauMap * map = iau_map_open(tables[i]);
+		if (map) {
+			if (!iau_lookup_add_map(lk, map)) {
+				iau_map_close(map);
+				iau_lookup_free(lk);
+				return NULL;
+			}
+			continue;
+		}
+		IauDict * dict = iau_dict_open(tables[i]);
+		if (dict) {
+			if (!iau_lookup_add_dict(lk, dict)) {
+				iau_dict_close(dict);
+				iau_lookup_free(lk);
+				return NULL;
+			}
+			continue;
+		}
+		IauRegistry * reg = iau_registry_load(tables[i], 0);
+		if (!reg || !iau_lookup_add(lk, reg)) {
+			fprintf(stderr, "Can't load table: %s \n", tables[i]);
+			iau_registry_free(reg);
+			iau_lookup_free(lk);
+			return NULL;
+		}
+	}
+	return lk;
+}
+
+/*Print the WKT of each requested code, tables are loaded once.
+ *"IAU2000:49962,lon,lat" requests are AUTO codes centered on lon, lat*/
+static int lookup_codes(char * const requests[], int nRequests, char * const tables[], int nTables)
+{
+	IauLookup * lk = load_lookup(tables, nTables);
+	IauBuf wkt = {NULL, 0, 0, 0};
+	int i, status = EXIT_SUCCESS;
+
+	if (!lk)
+		return(EXIT_FAILURE);
+	for (i = 0; i < nRequests; i++) {
+		const char * found;
+		if (strchr(requests[i], ',')) {
+			wkt.len = 0;
+			found = iau_lookup_auto_string(lk, &wkt, requests[i]) ? wkt.data : NULL;
+		} else {
+			found = iau_lookup_string(lk, requests[i]);
+			wkt.len = found ? strlen(found) : 0;
+		}
+		if (found) {
+			printf("%.*s\n", (int)wkt.len, found);
+		} else {
+			fprintf(stderr, "Unknown code: %s\n", requests[i]);
+			status = EXIT_FAILURE;
+		}
+	}
+	iau_buf_free(&wkt);
+	iau_lookup_free(lk);
+	return status;
+}
+
+/*Resolve "IAU2000:49962,lon,lat" requests read from the standard input,
+ *one WKT line per request on the standard output, empty if it failed*/
+static int resolve_auto(char * const tables[], int nTables)
+{
+	IauLookup * lk = load_lookup(tables, nTables);
+	IauReader reader;
+	IauWriter writer;
+	char * line;
+	int status = EXIT_SUCCESS;
+
+	if (!lk)
+		return(EXIT_FAILURE);
+	iau_reader_init(&reader, STDIN_FILENO);
+	iau_writer_init(&writer, STDOUT_FILENO, OUTPUT_FLUSH_SIZE);
+	for (;;) {
+		if (iau_reader_would_block(&reader))
+			iau_writer_flush(&writer);
+		line = iau_reader_line(&reader);
+		if (!line)
+			break;
+		if (!iau_lookup_auto_string(lk, &writer.buf, line)) {
+			fprintf(stderr, "Unknown code: %s\n", line);
+			status = EXIT_FAILURE;
+		}
+		iau_buf_printf(&writer.buf, "\n");
+		iau_writer_commit(&writer);
+	}
+	if (reader.error) {
+		perror("stdin");
+		status = EXIT_FAILURE;
+	}
+	if (!iau_writer_close(&writer)) {
+		perror("stdout");
+		status = EXIT_FAILURE;
+	}
+	iau_reader_free(&reader);
+	iau_lookup_free(lk);
+	return status;
+}
+
+/*Long options, given as their value when no short option has it*/
+enum {
+	OPT_STATS = 256,
+	OPT_STATS_JSON
+};
+
+static const struct option longOptions[] = {
+	{"stats", no_argument, NULL, OPT_STATS},
+	{"stats-json", required_argument, NULL, OPT_STATS_JSON},
+	{NULL, 0, NULL, 0}
+};
+
+/*Print the statistics of a generation run, text to stderr and JSON to
+ *jsonPath if given*/
+static int report_stats(IauStats * stats, int text, const char * jsonPath)
+{
+	FILE * f;
+
+	if (text)
+		iau_stats_print(stderr, stats);
+	if (!jsonPath)
+		return(EXIT_SUCCESS);
+	f = open_stream(jsonPath, 1);
+	if (!f) {
+		perror(jsonPath);
+		return(EXIT_FAILURE);
+	}
+	iau_stats_json(f, stats);
+	if (!close_stream(f)) {
+		perror(jsonPath);
+		return(EXIT_FAILURE);
 	}
-	fclose(stream);
-	fclose(f1);
 	return(EXIT_SUCCESS);
 }
+
+int main(int argc, char * argv[])
+{
+	char ** requests = malloc(argc * sizeof(char *));
+	int nRequests = 0;
+	int autoRequests = 0;
+	int expand = 0;
+	const char * registry = NULL;
+	const char * state = NULL;
+	const char * extra[EXTRA_COUNT] = {NULL, NULL, NULL, NULL};
+	int nThreads = 1;
+	int theYear = 0;
+	int statsText = 0;
+	const char * statsJson = NULL;
+	int opt, status;
+
+	if (!requests) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	while ((opt = getopt_long(argc, argv, "l:axr:i:p:w:J:d:j:e:h", longOptions, NULL)) != -1) {
+		switch (opt) {
+		case 'l':
+			requests[nRequests++] = optarg;
+			break;
+		case 'a':
+			autoRequests = 1;
+			break;
+		case 'r':
+			registry = optarg;
+			break;
+		case 'i':
+			state = optarg;
+			break;
+		case 'p':
+			extra[EXTRA_PROJ4] = optarg;
+			break;
+		case 'w':
+			extra[EXTRA_WKT2] = optarg;
+			break;
+		case 'J':
+			extra[EXTRA_PROJJSON] = optarg;
+			break;
+		case 'd':
+			extra[EXTRA_DICT] = optarg;
+			break;
+		case 'x':
+			expand = 1;
+			break;
+		case 'e':
+			/*IAU2009 or 2009*/
+			theYear = atoi(strncmp(optarg, "IAU", 3) == 0 ? optarg + 3 : optarg);
+			break;
+		case 'j':
+			nThreads = atoi(optarg);
+			if (nThreads <= 0)
+				nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+			if (nThreads <= 0)
+				nThreads = 1;
+			break;
+		case OPT_STATS:
+			statsText = 1;
+			break;
+		case OPT_STATS_JSON:
+			statsJson = optarg;
+			break;
+		case 'h':
+			usage();
+			free(requests);
+			exit(EXIT_SUCCESS);
+		default:
+			usage();
+			free(requests);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if ((statsText || statsJson) && (expand || nRequests || autoRequests || state)) {
+		/*Only generation runs are instrumented*/
+		usage();
+		free(requests);
+		exit(EXIT_FAILURE);
+	}
+	if (expand) {
+		if (argc - optind != 2 || nRequests || autoRequests) {
+			usage();
+			free(requests);
+			exit(EXIT_FAILURE);
+		}
+		status = expand_dict(argv[optind], argv[optind + 1]);
+	} else if (nRequests || autoRequests) {
+		if (optind >= argc || (nRequests && autoRequests)) {
+			usage();
+			free(requests);
+			exit(EXIT_FAILURE);
+		}
+		if (autoRequests)
+			status = resolve_auto(argv + optind, argc - optind);
+		else
+			status = lookup_codes(requests, nRequests, argv + optind, argc - optind);
+	} else {
+		int nPairs = (argc - optind) / 2;
+		if (nPairs < 1 || (argc - optind) % 2 != 0
+		|| (nPairs > 1 && (extra[EXTRA_PROJ4] || extra[EXTRA_WKT2] || extra[EXTRA_PROJJSON] || extra[EXTRA_DICT] || registry))
+		|| (registry && strcmp(argv[optind], "-") == 0)
+		|| (state && (nPairs > 1 || strcmp(argv[optind + 1], "-") == 0
+			|| extra[EXTRA_PROJ4] || extra[EXTRA_WKT2] || extra[EXTRA_PROJJSON] || extra[EXTRA_DICT]))) {
+			usage();
+			free(requests);
+			exit(EXIT_FAILURE);
+		}
+		if (state) {
+			status = update(argv[optind], argv[optind + 1], state, theYear);
+			if (status == EXIT_SUCCESS && registry)
+				status = write_registry(argv[optind], registry, theYear);
+		} else {
+			IauStats stats;
+			IauStats * pStats = statsText || statsJson ? &stats : NULL;
+			size_t allocations, reallocations, frees;
+
+			memset(&stats, 0, sizeof(stats));
+			iau_heap_counts(&allocations, &reallocations, &frees);
+			if (nPairs == 1 && nThreads == 1) {
+				status = generate(argv[optind], argv[optind + 1], extra, theYear, pStats);
+				if (status == EXIT_SUCCESS && registry)
+					status = write_registry(argv[optind], registry, theYear);
+			} else {
+				status = generate_batches(argv + optind, nPairs, nThreads, extra, registry, theYear, pStats);
+			}
+			if (pStats) {
+				iau_heap_counts(&stats.allocations, &stats.reallocations, &stats.frees);
+				stats.allocations -= allocations;
+				stats.reallocations -= reallocations;
+				stats.frees -= frees;
+				if (report_stats(&stats, statsText, statsJson) != EXIT_SUCCESS)
+					status = EXIT_FAILURE;
+			}
+		}
+	}
+	free(requests);
+	return status;
+}
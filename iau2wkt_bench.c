@@ -0,0 +1,318 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/resource.h>
+#include<sys/wait.h>
+#include<math.h>
+#include "iauwkt.h"
+
+/*------------------------------------------------------------------------------
+ *  iau2wkt_bench: time the generation path on synthetic NAIF tables
+ *
+ *  For every requested size a table is synthesised in memory, mixing spheres,
+ *  oblate spheroids and triaxial bodies, then run through the stages of the
+ *  generator, each timed on its own:
+ *
+ *    parse		iau_parse_row over every line
+ *    geogcs		one GEOGCS fragment per body
+ *    projections	every catalog code of every body, reported per family
+ *    output		full code blocks through an IauWriter
+ *    latitude		ocentric to ographic conversion of LAT_POINTS
+ *			latitudes per body, vectorized then libm reference;
+ *			the run fails if they differ by more than
+ *			IAU_LAT_TOLERANCE, also outside [-90, 90]
+ *
+ *  Each size runs in a child process so its peak RSS is its own.
+ *
+ *  License: Public Domain
+ *------------------------------------------------------------------------------
+*/
+
+#define BLOCK_BODIES 1024
+#define LAT_POINTS 4096
+
+void usage(){
+	printf("usage:\n\tiau2wkt_bench [-o outputFileName] bodies [bodies ...]\n");
+	printf("\toutput goes to /dev/null unless -o is given\n");
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*xorshift32, fixed seed so that runs are comparable*/
+static unsigned int rng_state = 2463534242u;
+
+static unsigned int rng(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+/*One in four bodies triaxial, the others spheres or oblate spheroids*/
+static char * synth_table(size_t nBodies, size_t * size, size_t * nTriaxial)
+{
+	IauBuf t = {NULL, 0, 0, 0};
+	size_t i;
+
+	*nTriaxial = 0;
+	iau_buf_printf(&t, "Naif_id,Body,IAU2009_Mean,IAU2009_Semimajor,IAU2009_Axisb,IAU2009_Semiminor\n");
+	for (i = 0; i < nBodies; i++) {
+		double a = 1000.0 + rng() % 7000000;
+		double b = a, c = a;
+		double mean;
+		switch (rng() % 4) {
+		case 0:
+			b = a * (0.6 + (rng() % 400) / 1000.0);
+			c = b * (0.6 + (rng() % 400) / 1000.0);
+			(*nTriaxial)++;
+			break;
+		case 1:
+			c = a * (0.9 + (rng() % 100) / 1000.0);
+			break;
+		}
+		mean = (a + b + c) / 3.0;
+		iau_buf_printf(&t, "%lu,Synth%lu,%.2f,%.2f,%.2f,%.2f\n",
+			(unsigned long)(2000001 + i), (unsigned long)i, mean, a, b, c);
+	}
+	*size = t.len;
+	return t.data;
+}
+
+static void report(const char * stage, double seconds, size_t rows, size_t bytes)
+{
+	printf("  %-12s %10.2f ms %12.0f rows/s", stage, seconds * 1e3, rows / seconds);
+	if (bytes)
+		printf(" %10.1f MB/s", bytes / seconds / 1e6);
+	printf("\n");
+}
+
+static void report_points(const char * stage, double seconds, size_t points)
+{
+	printf("  %-12s %10.2f ms %12.0f points/s\n", stage, seconds * 1e3, points / seconds);
+}
+
+/*Latitudes outside the vectorized domain, compared but not timed*/
+static const double latOutside[] = {
+	-1e6, -270.0, -180.0, -120.0, -90.000001, 90.000001, 120.0, 180.0, 270.0, 1e6
+};
+#define LAT_OUTSIDE (sizeof(latOutside) / sizeof(latOutside[0]))
+
+/*Largest difference between the vectorized and reference conversions of n
+ *latitudes*/
+static double lat_diff(const IauEllipsoid * e, const double * lat, double * fast, double * ref, size_t n)
+{
+	double maxDiff = 0;
+	size_t j;
+
+	iau_convert_lat(e, IAU_TO_GRAPHIC, lat, fast, n);
+	iau_convert_lat_ref(e, IAU_TO_GRAPHIC, lat, ref, n);
+	for (j = 0; j < n; j++)
+		if (!(fabs(fast[j] - ref[j]) <= maxDiff))
+			maxDiff = fabs(fast[j] - ref[j]);
+	return maxDiff;
+}
+
+/*Vectorized and reference conversion over the same latitudes of every
+ *body, with the largest difference between the two. Returns 0 if it is
+ *larger than IAU_LAT_TOLERANCE*/
+static int bench_latitude(const IauBody * bodies, size_t nRows)
+{
+	double * lat = malloc(LAT_POINTS * sizeof(double));
+	double * fast = malloc(LAT_POINTS * sizeof(double));
+	double * ref = malloc(LAT_POINTS * sizeof(double));
+	double tFast = 0, tRef = 0, maxDiff = 0, maxOutside = 0, diff, t0;
+	IauEllipsoid e;
+	size_t i, j;
+
+	if (!lat || !fast || !ref) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	for (j = 0; j < LAT_POINTS; j++)
+		lat[j] = -90.0 + 180.0 * j / (LAT_POINTS - 1);
+	for (i = 0; i < nRows; i++) {
+		iau_ellipsoid_init(&e, &bodies[i]);
+		t0 = now();
+		iau_convert_lat(&e, IAU_TO_GRAPHIC, lat, fast, LAT_POINTS);
+		tFast += now() - t0;
+		t0 = now();
+		iau_convert_lat_ref(&e, IAU_TO_GRAPHIC, lat, ref, LAT_POINTS);
+		tRef += now() - t0;
+		for (j = 0; j < LAT_POINTS; j++)
+			if (!(fabs(fast[j] - ref[j]) <= maxDiff))
+				maxDiff = fabs(fast[j] - ref[j]);
+		diff = lat_diff(&e, latOutside, fast, ref, LAT_OUTSIDE);
+		if (!(diff <= maxOutside))
+			maxOutside = diff;
+	}
+	report_points("latitude", tFast, nRows * LAT_POINTS);
+	report_points("latitude ref", tRef, nRows * LAT_POINTS);
+	printf("  max |vectorized - reference| %.3g degree, %.3g outside [-90, 90]\n", maxDiff, maxOutside);
+	free(lat);
+	free(fast);
+	free(ref);
+	if (!(maxDiff <= IAU_LAT_TOLERANCE && maxOutside <= IAU_LAT_TOLERANCE)) {
+		fprintf(stderr, "latitude conversion off by more than %g degree\n", IAU_LAT_TOLERANCE);
+		return 0;
+	}
+	return 1;
+}
+
+static int run(size_t nBodies, const char * output)
+{
+	size_t size, nTriaxial, nRows = 0, inBytes, outBytes = 0;
+	char * table = synth_table(nBodies, &size, &nTriaxial);
+	IauBody * bodies = malloc((nBodies ? nBodies : 1) * sizeof(IauBody));
+	int nCodes = iau_catalog_size();
+	double * codeTime = calloc(nCodes, sizeof(double));
+	IauBuf geogcs[BLOCK_BODIES];
+	IauBuf out = {NULL, 0, 0, 0};
+	IauWriter w;
+	double t0, tGeogcs = 0, tWrite = 0, tOutput;
+	size_t i, j, first;
+	char * line;
+	char * next;
+	int k, fd, rc;
+	struct rusage ru;
+
+	if (!table || !bodies || !codeTime) {
+		perror("malloc");
+		return 1;
+	}
+	memset(geogcs, 0, sizeof(geogcs));
+	inBytes = size;
+
+	/*parse*/
+	t0 = now();
+	for (line = table; line < table + size; line = next) {
+		next = memchr(line, '\n', table + size - line);
+		next = next ? next + 1 : table + size;
+		if (iau_parse_row(line, &bodies[nRows]))
+			nRows++;
+	}
+	double tParse = now() - t0;
+
+	/*geogcs and per projection formatting, by blocks of bodies*/
+	for (first = 0; first < nRows; first += BLOCK_BODIES) {
+		size_t n = nRows - first < BLOCK_BODIES ? nRows - first : BLOCK_BODIES;
+		t0 = now();
+		for (j = 0; j < n; j++)
+			iau_format_geogcs(&geogcs[j], &bodies[first + j], 2009);
+		tGeogcs += now() - t0;
+		for (k = 0; k < nCodes; k++) {
+			int offset = iau_catalog_offset(k);
+			t0 = now();
+			for (j = 0; j < n; j++) {
+				out.len = 0;
+				iau_format_wkt(&out, &geogcs[j], &bodies[first + j], 2009, offset);
+			}
+			codeTime[k] += now() - t0;
+		}
+	}
+
+	/*output*/
+	fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		perror(output);
+		return 1;
+	}
+	iau_writer_init(&w, fd, 1 << 20);
+	t0 = now();
+	for (i = 0; i < nRows; i++) {
+		iau_format_body(&w.buf, &geogcs[0], &bodies[i], 2009);
+		if (w.buf.len >= w.flushSize) {
+			double t1 = now();
+			outBytes += w.buf.len;
+			iau_writer_flush(&w);
+			tWrite += now() - t1;
+		}
+	}
+	double t1 = now();
+	outBytes += w.buf.len;
+	iau_writer_close(&w);
+	close(fd);
+	tWrite += now() - t1;
+	tOutput = now() - t0;
+
+	printf("bodies %lu (%lu triaxial), input %.1f MB\n",
+		(unsigned long)nRows, (unsigned long)nTriaxial, inBytes / 1e6);
+	report("parse", tParse, nRows, inBytes);
+	report("geogcs", tGeogcs, nRows, 0);
+	for (k = 0; k < nCodes; k++) {
+		/*Entries of one family are consecutive in the catalog*/
+		const char * label = iau_catalog_label(k);
+		double t = codeTime[k];
+		int n = 1;
+		while (k + 1 < nCodes && strcmp(iau_catalog_label(k + 1), label) == 0) {
+			t += codeTime[++k];
+			n++;
+		}
+		printf("    %-36s %2d codes %8.1f ns/code\n", label, n, nRows ? t / (nRows * n) * 1e9 : 0.0);
+	}
+	report("format+write", tOutput, nRows, outBytes);
+	report("write", tWrite, nRows, outBytes);
+	rc = !bench_latitude(bodies, nRows);
+	getrusage(RUSAGE_SELF, &ru);
+	printf("  peak RSS     %10ld kB\n", ru.ru_maxrss);
+
+	for (j = 0; j < BLOCK_BODIES; j++)
+		iau_buf_free(&geogcs[j]);
+	iau_buf_free(&out);
+	free(codeTime);
+	free(bodies);
+	free(table);
+	return rc;
+}
+
+int main(int argc, char * argv[])
+{
+	const char * output = "/dev/null";
+	int opt, i, status = EXIT_SUCCESS;
+
+	while ((opt = getopt(argc, argv, "o:h")) != -1) {
+		switch (opt) {
+		case 'o':
+			output = optarg;
+			break;
+		case 'h':
+			usage();
+			exit(EXIT_SUCCESS);
+		default:
+			usage();
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (optind >= argc) {
+		usage();
+		exit(EXIT_FAILURE);
+	}
+	for (i = optind; i < argc; i++) {
+		size_t nBodies = strtoul(argv[i], NULL, 10);
+		int wstatus;
+		pid_t pid;
+
+		fflush(stdout);
+		pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			exit(EXIT_FAILURE);
+		}
+		if (pid == 0) {
+			int rc = run(nBodies, output);
+			fflush(stdout);
+			_exit(rc);
+		}
+		if (waitpid(pid, &wstatus, 0) < 0 || !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+			status = EXIT_FAILURE;
+	}
+	return status;
+}
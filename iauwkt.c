@@ -0,0 +1,3386 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdarg.h>
+#include<stdint.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<pthread.h>
+#include<errno.h>
+#include<poll.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<math.h>
+#include<time.h>
+#include "iauwkt.h"
+
+/*------------------------------------------------------------------------------
+ *  iauwkt: projection catalog, table reader, body registry and code lookup
+ *  shared by the iau2wkt generator and by servers embedding the lookup.
+ *
+ *  License: Public Domain
+ *------------------------------------------------------------------------------
+*/
+
+/*------------------------------------------------------------------------------
+ * Projection catalog
+ *
+ * Every code written for a body is gisCode = NaifNum * 100 + offset.
+ * A family describes one projection (its PROJCS name, PROJECTION method and
+ * PARAMETER list), an entry binds a family to a code offset, an
+ * ocentric (even) / ographic (odd) variant and a central longitude.
+ *------------------------------------------------------------------------------
+*/
+
+#define MAX_PARAMS 4
+
+typedef struct {
+	const char * name;
+	const char * value;
+	const char * proj;	/*PROJ.4 parameter key*/
+} Param;
+
+typedef struct {
+	const char * label;	/*Used in the "# ..." comment line*/
+	const char * name;	/*PROJCS name suffix, NULL for a GEOGCS*/
+	const char * method;	/*PROJECTION[]*/
+	const char * center;	/*PARAMETER holding the central longitude*/
+	const char * proj;	/*PROJ.4 +proj name*/
+	Param params[MAX_PARAMS];	/*PARAMETERs following the central longitude*/
+} Family;
+
+enum {
+	FAM_GEOGCS,
+	FAM_EQUIRECTANGULAR,
+	FAM_SINUSOIDAL,
+	FAM_NORTH_POLAR,
+	FAM_SOUTH_POLAR,
+	FAM_MOLLWEIDE,
+	FAM_ROBINSON,
+	FAM_SINUSOIDAL_AUTO,
+	FAM_STEREOGRAPHIC_AUTO,
+	FAM_TRANSVERSE_MERCATOR_AUTO,
+	FAM_ORTHOGRAPHIC_AUTO,
+	FAM_EQUIDISTANT_CYLINDRICAL_AUTO,
+	FAM_LAMBERT_CONFORMAL_CONIC_AUTO,
+	FAM_LAMBERT_AZIMUTHAL_EQUAL_AREA_AUTO,
+	FAM_MERCATOR_AUTO,
+	FAM_ALBERS_AUTO,
+	FAM_OBLIQUE_CYLINDRICAL_EQUAL_AREA_AUTO,
+	FAM_MOLLWEIDE_AUTO,
+	FAM_ROBINSON_AUTO,
+	FAM_COUNT
+};
+
+static const Family families[FAM_COUNT] = {
+	{"GEOGCS", NULL, NULL, NULL, "longlat", {{NULL, NULL, NULL}}},
+	{"Equirectangular", "Equidistant_Cylindrical", "Equirectangular", "Central_Meridian", "eqc",
+		{{"Standard_Parallel_1", "0", "lat_ts"}}},
+	{"Sinusoidal", "Sinusoidal", "Sinusoidal", "Central_Meridian", "sinu", {{NULL, NULL, NULL}}},
+	{"North Polar", "North_Pole_Stereographic", "Stereographic", "Central_Meridian", "stere",
+		{{"Scale_Factor", "1", "k"}, {"Latitude_Of_Origin", "90", "lat_0"}}},
+	{"South Polar", "South_Pole_Stereographic", "Stereographic", "Central_Meridian", "stere",
+		{{"Scale_Factor", "1", "k"}, {"Latitude_Of_Origin", "-90", "lat_0"}}},
+	{"Mollweide", "Mollweide", "Mollweide", "Central_Meridian", "moll", {{NULL, NULL, NULL}}},
+	{"Robinson", "Robinson", "Robinson", "Central_Meridian", "robin", {{NULL, NULL, NULL}}},
+	{"Sinusoidal AUTO", "Sinusoidal_AUTO", "Sinusoidal", "Central_Meridian", "sinu", {{NULL, NULL, NULL}}},
+	{"Stereographic AUTO", "Stereographic_AUTO", "Stereographic", "Central_Meridian", "stere",
+		{{"Scale_Factor", "1", "k"}, {"Latitude_Of_Origin", "0", "lat_0"}}},
+	{"Transverse Mercator AUTO", "Transverse_Mercator_AUTO", "Transverse_Mercator", "Central_Meridian", "tmerc",
+		{{"Scale_Factor", "0.9996", "k"}, {"Latitude_Of_Origin", "0", "lat_0"}}},
+	{"Orthographic AUTO", "Orthographic_AUTO", "Orthographic", "Longitude_Of_Center", "ortho",
+		{{"Latitude_Of_Center", "90.0", "lat_0"}}},
+	{"Equidistant Cylindrical AUTO", "Equidistant_Cylindrical_AUTO", "Equirectangular", "Central_Meridian", "eqc",
+		{{"Standard_Parallel_1", "0", "lat_ts"}}},
+	{"Lambert Conformal Conic AUTO", "Lambert_Conformal_Conic_AUTO", "Lambert_Conformal_Conic_2SP", "Central_Meridian", "lcc",
+		{{"Standard_Parallel_1", "-20", "lat_1"}, {"Standard_Parallel_2", "20", "lat_2"}, {"Latitude_Of_Origin", "0", "lat_0"}}},
+	{"Lambert Azimuthal Equal Area AUTO", "Lambert_Azimuthal_Equal_Area_AUTO", "Lambert_Azimuthal_Equal_Area", "Central_Meridian", "laea",
+		{{"Latitude_Of_Origin", "90", "lat_0"}}},
+	{"Mercator AUTO", "Mercator_AUTO", "Mercator_1SP", "Central_Meridian", "merc",
+		{{"Standard_Parallel_1", "0", "lat_ts"}}},
+	{"Albers AUTO", "Albers_AUTO", "Albers_Conic_Equal_Area", "Central_Meridian", "aea",
+		{{"Standard_Parallel_1", "60.0", "lat_1"}, {"Standard_Parallel_2", "20.0", "lat_2"}, {"Latitude_Of_Origin", "40.0", "lat_0"}}},
+	/*Only the central meridian and standard parallel are given, that is the normal aspect*/
+	{"Oblique Cylindrical Equal Area AUTO", "Oblique_Cylindrical_Equal_Area_AUTO", "Oblique_Cylindrical_Equal_Area", "Central_Meridian", "cea",
+		{{"Standard_Parallel_1", "0.0", "lat_ts"}}},
+	{"Mollweide AUTO", "Mollweide_AUTO", "Mollweide", "Central_Meridian", "moll", {{NULL, NULL, NULL}}},
+	{"Robinson AUTO", "Robinson_AUTO", "Robinson", "Central_Meridian", "robin", {{NULL, NULL, NULL}}},
+};
+
+typedef struct {
+	int offset;		/*gisCode = NaifNum * 100 + offset*/
+	int family;
+	int graphic;		/*0 = ocentric (even), 1 = ographic (odd)*/
+	const char * clon;	/*Central longitude as written in the WKT*/
+	const char * clonLabel;	/*Central longitude shown in the comment, NULL if none*/
+} Entry;
+
+static const Entry entries[] = {
+	/*GEOIDS*/
+	{ 0, FAM_GEOGCS, 0, NULL, NULL},
+	{ 1, FAM_GEOGCS, 1, NULL, NULL},
+	/*#Static Projections*/
+	{10, FAM_EQUIRECTANGULAR, 0, "0", "0"},
+	{11, FAM_EQUIRECTANGULAR, 1, "0", "0"},
+	{12, FAM_EQUIRECTANGULAR, 0, "180", "180"},
+	{13, FAM_EQUIRECTANGULAR, 1, "180", "180"},
+	{14, FAM_SINUSOIDAL, 0, "0", "0"},
+	{15, FAM_SINUSOIDAL, 1, "0", "0"},
+	{16, FAM_SINUSOIDAL, 0, "180", "180"},
+	{17, FAM_SINUSOIDAL, 1, "180", "180"},
+	{18, FAM_NORTH_POLAR, 0, "0", "0"},
+	{19, FAM_NORTH_POLAR, 1, "0", "0"},
+	{20, FAM_SOUTH_POLAR, 0, "0", "0"},
+	{21, FAM_SOUTH_POLAR, 1, "0", "0"},
+	{22, FAM_MOLLWEIDE, 0, "0", "0"},
+	{23, FAM_MOLLWEIDE, 1, "0", "0"},
+	{24, FAM_MOLLWEIDE, 0, "180", "180"},
+	{25, FAM_MOLLWEIDE, 1, "180", "180"},
+	{26, FAM_ROBINSON, 0, "0", "0"},
+	{27, FAM_ROBINSON, 1, "0", "0"},
+	{28, FAM_ROBINSON, 0, "180", "180"},
+	{29, FAM_ROBINSON, 1, "180", "180"},
+	/*#AUTO Projections*/
+	{60, FAM_SINUSOIDAL_AUTO, 0, "0", NULL},
+	{61, FAM_SINUSOIDAL_AUTO, 1, "0", NULL},
+	{62, FAM_STEREOGRAPHIC_AUTO, 0, "0", "0"},
+	{63, FAM_STEREOGRAPHIC_AUTO, 1, "0", "0"},
+	{64, FAM_TRANSVERSE_MERCATOR_AUTO, 0, "0", NULL},
+	{65, FAM_TRANSVERSE_MERCATOR_AUTO, 1, "0", NULL},
+	{66, FAM_ORTHOGRAPHIC_AUTO, 0, "0.0", NULL},
+	{67, FAM_ORTHOGRAPHIC_AUTO, 1, "0.0", NULL},
+	{68, FAM_EQUIDISTANT_CYLINDRICAL_AUTO, 0, "0", NULL},
+	{69, FAM_EQUIDISTANT_CYLINDRICAL_AUTO, 1, "0", NULL},
+	{70, FAM_LAMBERT_CONFORMAL_CONIC_AUTO, 0, "0", NULL},
+	{71, FAM_LAMBERT_CONFORMAL_CONIC_AUTO, 1, "0", NULL},
+	{72, FAM_LAMBERT_AZIMUTHAL_EQUAL_AREA_AUTO, 0, "0", NULL},
+	{73, FAM_LAMBERT_AZIMUTHAL_EQUAL_AREA_AUTO, 1, "0", NULL},
+	{74, FAM_MERCATOR_AUTO, 0, "0", NULL},
+	{75, FAM_MERCATOR_AUTO, 1, "0", NULL},
+	{76, FAM_ALBERS_AUTO, 0, "0.0", NULL},
+	{77, FAM_ALBERS_AUTO, 1, "0.0", NULL},
+	{78, FAM_OBLIQUE_CYLINDRICAL_EQUAL_AREA_AUTO, 0, "0.0", NULL},
+	{79, FAM_OBLIQUE_CYLINDRICAL_EQUAL_AREA_AUTO, 1, "0.0", NULL},
+	{80, FAM_MOLLWEIDE_AUTO, 0, "0", NULL},
+	{81, FAM_MOLLWEIDE_AUTO, 1, "0", NULL},
+	{82, FAM_ROBINSON_AUTO, 0, "0", NULL},
+	{83, FAM_ROBINSON_AUTO, 1, "0", NULL},
+};
+
+#define ENTRY_COUNT ((int)(sizeof(entries) / sizeof(entries[0])))
+
+/*AUTO codes are centered on request: the central longitude takes the
+ *requested longitude, and this PARAMETER, if any, the requested latitude*/
+#define AUTO_FIRST_OFFSET 60
+
+static const char * const autoLatitude[FAM_COUNT] = {
+	[FAM_STEREOGRAPHIC_AUTO] = "Latitude_Of_Origin",
+	[FAM_TRANSVERSE_MERCATOR_AUTO] = "Latitude_Of_Origin",
+	[FAM_ORTHOGRAPHIC_AUTO] = "Latitude_Of_Center",
+	[FAM_EQUIDISTANT_CYLINDRICAL_AUTO] = "Standard_Parallel_1",
+	[FAM_LAMBERT_CONFORMAL_CONIC_AUTO] = "Latitude_Of_Origin",
+	[FAM_LAMBERT_AZIMUTHAL_EQUAL_AREA_AUTO] = "Latitude_Of_Origin",
+	[FAM_MERCATOR_AUTO] = "Standard_Parallel_1",
+	[FAM_ALBERS_AUTO] = "Latitude_Of_Origin",
+	[FAM_OBLIQUE_CYLINDRICAL_EQUAL_AREA_AUTO] = "Standard_Parallel_1",
+};
+
+/*------------------------------------------------------------------------------
+ * ISO 19162:2019 (WKT2) and PROJJSON description of the families: the
+ * conversion method and its parameters, in EPSG order with EPSG codes where
+ * the registry has them, each taking its value from the WKT1 catalog above.
+ *------------------------------------------------------------------------------
+*/
+
+#define MAX_METHOD_PARAMS 6
+
+enum {
+	UNIT_DEGREE,
+	UNIT_METRE,
+	UNIT_UNITY
+};
+
+enum {
+	SRC_CENTER = -1,	/*Entry central longitude*/
+	SRC_ZERO = -2		/*False easting and northing*/
+	/*0.. index into Family.params*/
+};
+
+typedef struct {
+	const char * name;
+	int epsg;
+	int unit;
+	int source;
+} MethodParam;
+
+typedef struct {
+	const char * name;
+	int epsg;
+	MethodParam params[MAX_METHOD_PARAMS];
+} Method;
+
+#define LON_NATURAL {"Longitude of natural origin", 8802, UNIT_DEGREE, SRC_CENTER}
+#define LON_FALSE {"Longitude of false origin", 8822, UNIT_DEGREE, SRC_CENTER}
+#define FALSE_EASTING {"False easting", 8806, UNIT_METRE, SRC_ZERO}
+#define FALSE_NORTHING {"False northing", 8807, UNIT_METRE, SRC_ZERO}
+#define EASTING_FALSE {"Easting at false origin", 8826, UNIT_METRE, SRC_ZERO}
+#define NORTHING_FALSE {"Northing at false origin", 8827, UNIT_METRE, SRC_ZERO}
+
+static const Method methods[FAM_COUNT] = {
+	[FAM_GEOGCS] = {NULL, 0, {{NULL, 0, 0, 0}}},
+	[FAM_EQUIRECTANGULAR] = {"Equidistant Cylindrical", 1028,
+		{{"Latitude of 1st standard parallel", 8823, UNIT_DEGREE, 0}, LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_SINUSOIDAL] = {"Sinusoidal", 0,
+		{LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_NORTH_POLAR] = {"Polar Stereographic (variant A)", 9810,
+		{{"Latitude of natural origin", 8801, UNIT_DEGREE, 1}, LON_NATURAL,
+		{"Scale factor at natural origin", 8805, UNIT_UNITY, 0}, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_SOUTH_POLAR] = {"Polar Stereographic (variant A)", 9810,
+		{{"Latitude of natural origin", 8801, UNIT_DEGREE, 1}, LON_NATURAL,
+		{"Scale factor at natural origin", 8805, UNIT_UNITY, 0}, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_MOLLWEIDE] = {"Mollweide", 0,
+		{LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_ROBINSON] = {"Robinson", 0,
+		{LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_SINUSOIDAL_AUTO] = {"Sinusoidal", 0,
+		{LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_STEREOGRAPHIC_AUTO] = {"Stereographic", 0,
+		{{"Latitude of natural origin", 8801, UNIT_DEGREE, 1}, LON_NATURAL,
+		{"Scale factor at natural origin", 8805, UNIT_UNITY, 0}, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_TRANSVERSE_MERCATOR_AUTO] = {"Transverse Mercator", 9807,
+		{{"Latitude of natural origin", 8801, UNIT_DEGREE, 1}, LON_NATURAL,
+		{"Scale factor at natural origin", 8805, UNIT_UNITY, 0}, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_ORTHOGRAPHIC_AUTO] = {"Orthographic", 9840,
+		{{"Latitude of natural origin", 8801, UNIT_DEGREE, 0}, LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_EQUIDISTANT_CYLINDRICAL_AUTO] = {"Equidistant Cylindrical", 1028,
+		{{"Latitude of 1st standard parallel", 8823, UNIT_DEGREE, 0}, LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_LAMBERT_CONFORMAL_CONIC_AUTO] = {"Lambert Conic Conformal (2SP)", 9802,
+		{{"Latitude of false origin", 8821, UNIT_DEGREE, 2}, LON_FALSE,
+		{"Latitude of 1st standard parallel", 8823, UNIT_DEGREE, 0},
+		{"Latitude of 2nd standard parallel", 8824, UNIT_DEGREE, 1}, EASTING_FALSE, NORTHING_FALSE}},
+	[FAM_LAMBERT_AZIMUTHAL_EQUAL_AREA_AUTO] = {"Lambert Azimuthal Equal Area", 9820,
+		{{"Latitude of natural origin", 8801, UNIT_DEGREE, 0}, LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_MERCATOR_AUTO] = {"Mercator (variant B)", 9805,
+		{{"Latitude of 1st standard parallel", 8823, UNIT_DEGREE, 0}, LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_ALBERS_AUTO] = {"Albers Equal Area", 9822,
+		{{"Latitude of false origin", 8821, UNIT_DEGREE, 2}, LON_FALSE,
+		{"Latitude of 1st standard parallel", 8823, UNIT_DEGREE, 0},
+		{"Latitude of 2nd standard parallel", 8824, UNIT_DEGREE, 1}, EASTING_FALSE, NORTHING_FALSE}},
+	/*Normal aspect, as for PROJ.4*/
+	[FAM_OBLIQUE_CYLINDRICAL_EQUAL_AREA_AUTO] = {"Lambert Cylindrical Equal Area", 9835,
+		{{"Latitude of 1st standard parallel", 8823, UNIT_DEGREE, 0}, LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_MOLLWEIDE_AUTO] = {"Mollweide", 0,
+		{LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+	[FAM_ROBINSON_AUTO] = {"Robinson", 0,
+		{LON_NATURAL, FALSE_EASTING, FALSE_NORTHING}},
+};
+
+int iau_catalog_size(void)
+{
+	return ENTRY_COUNT;
+}
+
+int iau_catalog_offset(int i)
+{
+	return i >= 0 && i < ENTRY_COUNT ? entries[i].offset : -1;
+}
+
+const char * iau_catalog_label(int i)
+{
+	return i >= 0 && i < ENTRY_COUNT ? families[entries[i].family].label : NULL;
+}
+
+/*------------------------------------------------------------------------------
+ * Heap accounting: every allocation of the library goes through these, so
+ * that a run can report how many it made and whether they were all freed
+ *------------------------------------------------------------------------------
+*/
+
+static size_t heapAllocations, heapReallocations, heapFrees;
+
+static void count_heap(size_t * counter)
+{
+	__atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+static void * count_malloc(size_t size)
+{
+	void * p = malloc(size);
+	if (p)
+		count_heap(&heapAllocations);
+	return p;
+}
+
+static void * count_calloc(size_t n, size_t size)
+{
+	void * p = calloc(n, size);
+	if (p)
+		count_heap(&heapAllocations);
+	return p;
+}
+
+static void * count_realloc(void * old, size_t size)
+{
+	void * p = realloc(old, size);
+	if (p)
+		count_heap(old ? &heapReallocations : &heapAllocations);
+	return p;
+}
+
+static char * count_strdup(const char * s)
+{
+	char * p = strdup(s);
+	if (p)
+		count_heap(&heapAllocations);
+	return p;
+}
+
+static void count_free(void * p)
+{
+	if (p)
+		count_heap(&heapFrees);
+	free(p);
+}
+
+void iau_heap_counts(size_t * allocations, size_t * reallocations, size_t * frees)
+{
+	*allocations = __atomic_load_n(&heapAllocations, __ATOMIC_RELAXED);
+	*reallocations = __atomic_load_n(&heapReallocations, __ATOMIC_RELAXED);
+	*frees = __atomic_load_n(&heapFrees, __ATOMIC_RELAXED);
+}
+
+/*------------------------------------------------------------------------------
+ * Output assembly buffer
+ *------------------------------------------------------------------------------
+*/
+
+/*Returns 0, and sets the sticky error flag, if the buffer can't grow.
+ *Appends to a failed buffer are dropped*/
+static int sb_reserve(IauBuf * sb, size_t extra)
+{
+	if (sb->error)
+		return 0;
+	if (sb->len + extra <= sb->cap)
+		return 1;
+	size_t cap = sb->cap ? sb->cap : 4096;
+	while (cap < sb->len + extra)
+		cap *= 2;
+	char * data = count_realloc(sb->data, cap);
+	if (!data) {
+		sb->error = 1;
+		return 0;
+	}
+	sb->data = data;
+	sb->cap = cap;
+	return 1;
+}
+
+/*Carry the failure of a scratch buffer over to out. 1 if out is complete*/
+static int sb_ok(IauBuf * out, const IauBuf * scratch)
+{
+	if (scratch && scratch->error)
+		out->error = 1;
+	return !out->error;
+}
+
+static void sb_append(IauBuf * sb, const char * s, size_t n)
+{
+	if (!n || !sb_reserve(sb, n))
+		return;
+	memcpy(sb->data + sb->len, s, n);
+	sb->len += n;
+}
+
+static void sb_puts(IauBuf * sb, const char * s)
+{
+	sb_append(sb, s, strlen(s));
+}
+
+/*Decimal digits of value into text (at least 12 chars), NUL terminated*/
+static size_t format_int(char * text, int value)
+{
+	char digits[16];
+	int n = 0;
+	size_t len = 0;
+	unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+	do {
+		digits[n++] = (char)('0' + v % 10);
+		v /= 10;
+	} while (v);
+	if (value < 0)
+		digits[n++] = '-';
+	while (n)
+		text[len++] = digits[--n];
+	text[len] = '\0';
+	return len;
+}
+
+static void sb_putint(IauBuf * sb, int value)
+{
+	char text[16];
+	sb_append(sb, text, format_int(text, value));
+}
+
+/*NUL terminate without counting the terminator in len, NULL on failure*/
+static const char * sb_cstr(IauBuf * sb)
+{
+	if (!sb_reserve(sb, 1))
+		return NULL;
+	sb->data[sb->len] = '\0';
+	return sb->data;
+}
+
+void iau_buf_printf(IauBuf * buf, const char * fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	int n = vsnprintf(NULL, 0, fmt, ap);
+	va_end(ap);
+	if (n < 0 || !sb_reserve(buf, (size_t)n + 1))
+		return;
+	va_start(ap, fmt);
+	vsnprintf(buf->data + buf->len, (size_t)n + 1, fmt, ap);
+	va_end(ap);
+	buf->len += (size_t)n;
+}
+
+void iau_buf_free(IauBuf * buf)
+{
+	count_free(buf->data);
+	buf->data = NULL;
+	buf->len = buf->cap = 0;
+	buf->error = 0;
+}
+
+/*------------------------------------------------------------------------------
+ * Code block writer
+ *------------------------------------------------------------------------------
+*/
+
+static const Entry * find_entry(int offset)
+{
+	int i;
+	for (i = 0; i < ENTRY_COUNT; i++)
+		if (entries[i].offset == offset)
+			return &entries[i];
+	return NULL;
+}
+
+void iau_format_geogcs(IauBuf * geogcs, const IauBody * body, int theYear)
+{
+	geogcs->len = 0;
+	iau_buf_printf(geogcs, "GEOGCS[\"%s %d\",DATUM[\"D_%s_%d\",SPHEROID[\"%s_%d_IAU_IAG\",%f,%f]],PRIMEM[\"Reference_Meridian\",0],UNIT[\"Decimal_Degree\",0.0174532925199433]",
+		body->target, theYear, body->target, theYear, body->target, theYear,
+		body->theA, body->flattening);
+}
+
+/*Append the WKT line of one catalog entry, without code prefix nor newline.
+ *Year and code are given as text, so that templates can hold placeholders*/
+static void append_wkt_text(IauBuf * out, const Entry * e, const char * theTarget,
+	const char * gisCode, const char * theYear, const IauBuf * geogcs)
+{
+	const Family * f = &families[e->family];
+
+	if (f->name) {
+		sb_puts(out, "PROJCS[\"");
+		sb_puts(out, theTarget);
+		sb_puts(out, "_");
+		sb_puts(out, f->name);
+		sb_puts(out, "\",");
+		sb_append(out, geogcs->data, geogcs->len);
+		sb_puts(out, "],PROJECTION[\"");
+		sb_puts(out, f->method);
+		sb_puts(out, "\"],PARAMETER[\"False_Easting\",0],PARAMETER[\"False_Northing\",0],PARAMETER[\"");
+		sb_puts(out, f->center);
+		sb_puts(out, "\",");
+		sb_puts(out, e->clon);
+		sb_puts(out, "]");
+		const Param * p;
+		for (p = f->params; p < f->params + MAX_PARAMS && p->name; p++) {
+			sb_puts(out, ",PARAMETER[\"");
+			sb_puts(out, p->name);
+			sb_puts(out, "\",");
+			sb_puts(out, p->value);
+			sb_puts(out, "]");
+		}
+		sb_puts(out, ",UNIT[\"Meter\",1]");
+	} else {
+		sb_append(out, geogcs->data, geogcs->len);
+	}
+	sb_puts(out, ",AUTHORITY[\"IAU");
+	sb_puts(out, theYear);
+	sb_puts(out, "\",\"");
+	sb_puts(out, gisCode);
+	sb_puts(out, "\"]]");
+}
+
+static void append_wkt(IauBuf * out, const Entry * e, const char * theTarget,
+	int gisCode, int theYear, const IauBuf * geogcs)
+{
+	char code[16], year[16];
+
+	format_int(code, gisCode);
+	format_int(year, theYear);
+	append_wkt_text(out, e, theTarget, code, year, geogcs);
+}
+
+/*Append the "# ..." comment line of one catalog entry*/
+static void append_comment(IauBuf * out, const Entry * e, const char * theTarget)
+{
+	const Family * f = &families[e->family];
+
+	sb_puts(out, "# ");
+	sb_puts(out, f->label);
+	sb_puts(out, " ");
+	sb_puts(out, theTarget);
+	sb_puts(out, e->graphic ? " Areographic" : " Areocentric");
+	if (e->clonLabel) {
+		sb_puts(out, ", clon=");
+		sb_puts(out, e->clonLabel);
+	}
+	sb_puts(out, "\n");
+}
+
+/*Append the "# ..." comment and the code line of one catalog entry*/
+static void append_entry(IauBuf * out, const Entry * e, const char * theTarget,
+	int theNaifNum, int theYear, const IauBuf * geogcs)
+{
+	int gisCode = theNaifNum * 100 + e->offset;
+
+	append_comment(out, e, theTarget);
+	sb_putint(out, gisCode);
+	sb_puts(out, ",");
+	append_wkt(out, e, theTarget, gisCode, theYear, geogcs);
+	sb_puts(out, "\n");
+}
+
+/*The GEOGCS fragment is formatted once and shared by all entries*/
+void iau_format_body(IauBuf * out, IauBuf * geogcs, const IauBody * body, int year)
+{
+	int i;
+
+	iau_format_geogcs(geogcs, body, year);
+	sb_puts(out, "# IAU");
+	sb_putint(out, year);
+	sb_puts(out, " WKT Codes for ");
+	sb_puts(out, body->target);
+	sb_puts(out, "\n");
+	/*Even = Areocentric*/
+	/*Odd = Areographic*/
+	for (i = 0; i < ENTRY_COUNT; i++)
+		append_entry(out, &entries[i], body->target, body->naifNum, year, geogcs);
+	sb_ok(out, geogcs);
+}
+
+int iau_format_wkt(IauBuf * out, const IauBuf * geogcs, const IauBody * body, int year, int offset)
+{
+	const Entry * e = find_entry(offset);
+
+	if (!e)
+		return 0;
+	append_wkt(out, e, body->target, body->naifNum * 100 + offset, year, geogcs);
+	return sb_ok(out, geogcs);
+}
+
+int iau_format_code(IauBuf * out, IauBuf * geogcs, const IauBody * body, int year, int offset)
+{
+	if (!find_entry(offset))
+		return 0;
+	iau_format_geogcs(geogcs, body, year);
+	return iau_format_wkt(out, geogcs, body, year, offset);
+}
+
+/*------------------------------------------------------------------------------
+ * PROJ.4 writer
+ *
+ * Same catalog as the WKT: each family names its +proj and each PARAMETER
+ * its PROJ.4 key. The ellipsoid is given by its axes, computed in double
+ * precision from the table radii rather than from the WKT1 flattening.
+ *------------------------------------------------------------------------------
+*/
+
+static void format_ellps(IauBuf * ellps, const IauBody * body)
+{
+	ellps->len = 0;
+	iau_buf_printf(ellps, " +a=%.15g +b=%.15g", body->semiMajor, body->semiMinor);
+}
+
+/*Append the "+proj=..." definition of one catalog entry*/
+static void append_proj4(IauBuf * out, const Entry * e, const IauBuf * ellps)
+{
+	const Family * f = &families[e->family];
+	const Param * p;
+
+	sb_puts(out, "+proj=");
+	sb_puts(out, f->proj);
+	if (f->name) {
+		sb_puts(out, " +lon_0=");
+		sb_puts(out, e->clon);
+		for (p = f->params; p < f->params + MAX_PARAMS && p->name; p++) {
+			sb_puts(out, " +");
+			sb_puts(out, p->proj);
+			sb_puts(out, "=");
+			sb_puts(out, p->value);
+		}
+		sb_puts(out, " +x_0=0 +y_0=0");
+	}
+	sb_append(out, ellps->data, ellps->len);
+	if (f->name)
+		sb_puts(out, " +units=m");
+	sb_puts(out, " +no_defs");
+}
+
+/*PROJ init file style: "# comment" then "<code> +proj=... <>"*/
+void iau_format_body_proj4(IauBuf * out, IauBuf * ellps, const IauBody * body)
+{
+	int i;
+
+	format_ellps(ellps, body);
+	for (i = 0; i < ENTRY_COUNT; i++) {
+		append_comment(out, &entries[i], body->target);
+		sb_puts(out, "<");
+		sb_putint(out, body->naifNum * 100 + entries[i].offset);
+		sb_puts(out, "> ");
+		append_proj4(out, &entries[i], ellps);
+		sb_puts(out, " <>\n");
+	}
+	sb_ok(out, ellps);
+}
+
+int iau_format_code_proj4(IauBuf * out, IauBuf * ellps, const IauBody * body, int offset)
+{
+	const Entry * e = find_entry(offset);
+
+	if (!e)
+		return 0;
+	format_ellps(ellps, body);
+	append_proj4(out, e, ellps);
+	return sb_ok(out, ellps);
+}
+
+/*------------------------------------------------------------------------------
+ * WKT2 and PROJJSON writers
+ *
+ * Both serialise the same CRS model: build_crs resolves a catalog entry into
+ * its ISO 19162 conversion, and the body part (names, datum, ellipsoid,
+ * prime meridian) is formatted once per body into a fragment shared by all
+ * its codes, as the GEOGCS is for the WKT1. Axes are in double precision,
+ * as for PROJ.4, and a sphere has an inverse flattening of 0.
+ *------------------------------------------------------------------------------
+*/
+
+#define DEGREE_WKT2 "ANGLEUNIT[\"degree\",0.0174532925199433]"
+#define PROJJSON_SCHEMA "https://proj.org/schemas/v0.7/projjson.schema.json"
+
+static const char * const unitWkt2[] = {
+	[UNIT_DEGREE] = DEGREE_WKT2,
+	[UNIT_METRE] = "LENGTHUNIT[\"metre\",1]",
+	[UNIT_UNITY] = "SCALEUNIT[\"unity\",1]"
+};
+
+static const char * const unitJson[] = {
+	[UNIT_DEGREE] = "degree",
+	[UNIT_METRE] = "metre",
+	[UNIT_UNITY] = "unity"
+};
+
+typedef struct {
+	const MethodParam * def;
+	const char * value;	/*As written in the WKT1 catalog*/
+} CrsParam;
+
+typedef struct {
+	const Family * family;
+	const Method * method;
+	const char * target;
+	int year;
+	int code;
+	int nParams;
+	CrsParam params[MAX_METHOD_PARAMS];
+} Crs;
+
+static void build_crs(Crs * crs, const Entry * e, const IauBody * body, int year)
+{
+	const Family * f = &families[e->family];
+	const Method * m = &methods[e->family];
+	const MethodParam * mp;
+
+	crs->family = f;
+	crs->method = m;
+	crs->target = body->target;
+	crs->year = year;
+	crs->code = body->naifNum * 100 + e->offset;
+	crs->nParams = 0;
+	for (mp = m->params; mp < m->params + MAX_METHOD_PARAMS && mp->name; mp++) {
+		CrsParam * p = &crs->params[crs->nParams++];
+		p->def = mp;
+		if (mp->source == SRC_CENTER)
+			p->value = e->clon;
+		else if (mp->source == SRC_ZERO)
+			p->value = "0";
+		else
+			p->value = f->params[mp->source].value;
+	}
+}
+
+static double inverse_flattening(const IauBody * body)
+{
+	if (body->semiMajor == body->semiMinor)
+		return 0;
+	return body->semiMajor / (body->semiMajor - body->semiMinor);
+}
+
+/*WKT2 quoted text, with '"' doubled*/
+static void sb_put_wkt2_text(IauBuf * sb, const char * s)
+{
+	const char * q;
+	while ((q = strchr(s, '"'))) {
+		sb_append(sb, s, q - s + 1);
+		sb_puts(sb, "\"");
+		s = q + 1;
+	}
+	sb_puts(sb, s);
+}
+
+/*JSON string content, escaped*/
+static void sb_put_json_text(IauBuf * sb, const char * s)
+{
+	for (; *s; s++) {
+		unsigned char ch = (unsigned char)*s;
+		if (ch == '"' || ch == '\\') {
+			char esc[2] = {'\\', (char)ch};
+			sb_append(sb, esc, 2);
+		} else if (ch < 0x20) {
+			iau_buf_printf(sb, "\\u%04x", ch);
+		} else {
+			sb_append(sb, s, 1);
+		}
+	}
+}
+
+/*"Mars 2000",DATUM[...],PRIMEM[...], the body part of GEOGCRS and BASEGEOGCRS*/
+static void format_datum_wkt2(IauBuf * datum, const IauBody * body, int year)
+{
+	datum->len = 0;
+	sb_puts(datum, "\"");
+	sb_put_wkt2_text(datum, body->target);
+	sb_puts(datum, " ");
+	sb_putint(datum, year);
+	sb_puts(datum, "\",DATUM[\"D_");
+	sb_put_wkt2_text(datum, body->target);
+	sb_puts(datum, "_");
+	sb_putint(datum, year);
+	sb_puts(datum, "\",ELLIPSOID[\"");
+	sb_put_wkt2_text(datum, body->target);
+	sb_puts(datum, "_");
+	sb_putint(datum, year);
+	iau_buf_printf(datum, "_IAU_IAG\",%.15g,%.15g,LENGTHUNIT[\"metre\",1]]]",
+		body->semiMajor, inverse_flattening(body));
+	sb_puts(datum, ",PRIMEM[\"Reference_Meridian\",0," DEGREE_WKT2 "]");
+}
+
+/*"name":...,"datum":...,"coordinate_system":..., the body part of a
+ *GeographicCRS object and of a ProjectedCRS base_crs*/
+static void format_datum_projjson(IauBuf * datum, const IauBody * body, int year)
+{
+	datum->len = 0;
+	sb_puts(datum, "\"name\":\"");
+	sb_put_json_text(datum, body->target);
+	sb_puts(datum, " ");
+	sb_putint(datum, year);
+	sb_puts(datum, "\",\"datum\":{\"type\":\"GeodeticReferenceFrame\",\"name\":\"D_");
+	sb_put_json_text(datum, body->target);
+	sb_puts(datum, "_");
+	sb_putint(datum, year);
+	sb_puts(datum, "\",\"ellipsoid\":{\"name\":\"");
+	sb_put_json_text(datum, body->target);
+	sb_puts(datum, "_");
+	sb_putint(datum, year);
+	if (body->semiMajor == body->semiMinor)
+		iau_buf_printf(datum, "_IAU_IAG\",\"radius\":%.15g}", body->semiMajor);
+	else
+		iau_buf_printf(datum, "_IAU_IAG\",\"semi_major_axis\":%.15g,\"inverse_flattening\":%.15g}",
+			body->semiMajor, inverse_flattening(body));
+	sb_puts(datum, ",\"prime_meridian\":{\"name\":\"Reference_Meridian\",\"longitude\":0}}"
+		",\"coordinate_system\":{\"subtype\":\"ellipsoidal\",\"axis\":["
+		"{\"name\":\"Geodetic latitude\",\"abbreviation\":\"Lat\",\"direction\":\"north\",\"unit\":\"degree\"},"
+		"{\"name\":\"Geodetic longitude\",\"abbreviation\":\"Lon\",\"direction\":\"east\",\"unit\":\"degree\"}]}");
+}
+
+static void append_wkt2(IauBuf * out, const Crs * crs, const IauBuf * datum)
+{
+	const Family * f = crs->family;
+	const Method * m = crs->method;
+	int i;
+
+	if (f->name) {
+		sb_puts(out, "PROJCRS[\"");
+		sb_put_wkt2_text(out, crs->target);
+		sb_puts(out, "_");
+		sb_puts(out, f->name);
+		sb_puts(out, "\",BASEGEOGCRS[");
+		sb_append(out, datum->data, datum->len);
+		sb_puts(out, "," DEGREE_WKT2 "],CONVERSION[\"");
+		sb_puts(out, f->label);
+		sb_puts(out, "\",METHOD[\"");
+		sb_puts(out, m->name);
+		sb_puts(out, "\"");
+		if (m->epsg) {
+			sb_puts(out, ",ID[\"EPSG\",");
+			sb_putint(out, m->epsg);
+			sb_puts(out, "]");
+		}
+		sb_puts(out, "]");
+		for (i = 0; i < crs->nParams; i++) {
+			const CrsParam * p = &crs->params[i];
+			sb_puts(out, ",PARAMETER[\"");
+			sb_puts(out, p->def->name);
+			sb_puts(out, "\",");
+			sb_puts(out, p->value);
+			sb_puts(out, ",");
+			sb_puts(out, unitWkt2[p->def->unit]);
+			if (p->def->epsg) {
+				sb_puts(out, ",ID[\"EPSG\",");
+				sb_putint(out, p->def->epsg);
+				sb_puts(out, "]");
+			}
+			sb_puts(out, "]");
+		}
+		sb_puts(out, "],CS[Cartesian,2],AXIS[\"(E)\",east,ORDER[1]],AXIS[\"(N)\",north,ORDER[2]],LENGTHUNIT[\"metre\",1]");
+	} else {
+		sb_puts(out, "GEOGCRS[");
+		sb_append(out, datum->data, datum->len);
+		sb_puts(out, ",CS[ellipsoidal,2],AXIS[\"geodetic latitude (Lat)\",north,ORDER[1]]"
+			",AXIS[\"geodetic longitude (Lon)\",east,ORDER[2]]," DEGREE_WKT2);
+	}
+	sb_puts(out, ",ID[\"IAU");
+	sb_putint(out, crs->year);
+	sb_puts(out, "\",");
+	sb_putint(out, crs->code);
+	sb_puts(out, "]]");
+}
+
+static void append_projjson(IauBuf * out, const Crs * crs, const IauBuf * datum)
+{
+	const Family * f = crs->family;
+	const Method * m = crs->method;
+	int i;
+
+	sb_puts(out, "{\"$schema\":\"" PROJJSON_SCHEMA "\",");
+	if (f->name) {
+		sb_puts(out, "\"type\":\"ProjectedCRS\",\"name\":\"");
+		sb_put_json_text(out, crs->target);
+		sb_puts(out, "_");
+		sb_puts(out, f->name);
+		sb_puts(out, "\",\"base_crs\":{");
+		sb_append(out, datum->data, datum->len);
+		sb_puts(out, "},\"conversion\":{\"name\":\"");
+		sb_puts(out, f->label);
+		sb_puts(out, "\",\"method\":{\"name\":\"");
+		sb_puts(out, m->name);
+		sb_puts(out, "\"");
+		if (m->epsg) {
+			sb_puts(out, ",\"id\":{\"authority\":\"EPSG\",\"code\":");
+			sb_putint(out, m->epsg);
+			sb_puts(out, "}");
+		}
+		sb_puts(out, "},\"parameters\":[");
+		for (i = 0; i < crs->nParams; i++) {
+			const CrsParam * p = &crs->params[i];
+			sb_puts(out, i ? ",{\"name\":\"" : "{\"name\":\"");
+			sb_puts(out, p->def->name);
+			sb_puts(out, "\",\"value\":");
+			sb_puts(out, p->value);
+			sb_puts(out, ",\"unit\":\"");
+			sb_puts(out, unitJson[p->def->unit]);
+			sb_puts(out, "\"");
+			if (p->def->epsg) {
+				sb_puts(out, ",\"id\":{\"authority\":\"EPSG\",\"code\":");
+				sb_putint(out, p->def->epsg);
+				sb_puts(out, "}");
+			}
+			sb_puts(out, "}");
+		}
+		sb_puts(out, "]},\"coordinate_system\":{\"subtype\":\"Cartesian\",\"axis\":["
+			"{\"name\":\"Easting\",\"abbreviation\":\"E\",\"direction\":\"east\",\"unit\":\"metre\"},"
+			"{\"name\":\"Northing\",\"abbreviation\":\"N\",\"direction\":\"north\",\"unit\":\"metre\"}]}");
+	} else {
+		sb_puts(out, "\"type\":\"GeographicCRS\",");
+		sb_append(out, datum->data, datum->len);
+	}
+	sb_puts(out, ",\"id\":{\"authority\":\"IAU");
+	sb_putint(out, crs->year);
+	sb_puts(out, "\",\"code\":");
+	sb_putint(out, crs->code);
+	sb_puts(out, "}}");
+}
+
+/*Same layout as the WKT1 file: "# comment" then "<code>,<WKT2>"*/
+void iau_format_body_wkt2(IauBuf * out, IauBuf * datum, const IauBody * body, int year)
+{
+	Crs crs;
+	int i;
+
+	format_datum_wkt2(datum, body, year);
+	sb_puts(out, "# IAU");
+	sb_putint(out, year);
+	sb_puts(out, " WKT2 Codes for ");
+	sb_puts(out, body->target);
+	sb_puts(out, "\n");
+	for (i = 0; i < ENTRY_COUNT; i++) {
+		build_crs(&crs, &entries[i], body, year);
+		append_comment(out, &entries[i], body->target);
+		sb_putint(out, crs.code);
+		sb_puts(out, ",");
+		append_wkt2(out, &crs, datum);
+		sb_puts(out, "\n");
+	}
+	sb_ok(out, datum);
+}
+
+int iau_format_code_wkt2(IauBuf * out, IauBuf * datum, const IauBody * body, int year, int offset)
+{
+	const Entry * e = find_entry(offset);
+	Crs crs;
+
+	if (!e)
+		return 0;
+	format_datum_wkt2(datum, body, year);
+	build_crs(&crs, e, body, year);
+	append_wkt2(out, &crs, datum);
+	return sb_ok(out, datum);
+}
+
+/*One PROJJSON object per line (NDJSON), the code is in its "id"*/
+void iau_format_body_projjson(IauBuf * out, IauBuf * datum, const IauBody * body, int year)
+{
+	Crs crs;
+	int i;
+
+	format_datum_projjson(datum, body, year);
+	for (i = 0; i < ENTRY_COUNT; i++) {
+		build_crs(&crs, &entries[i], body, year);
+		append_projjson(out, &crs, datum);
+		sb_puts(out, "\n");
+	}
+	sb_ok(out, datum);
+}
+
+int iau_format_code_projjson(IauBuf * out, IauBuf * datum, const IauBody * body, int year, int offset)
+{
+	const Entry * e = find_entry(offset);
+	Crs crs;
+
+	if (!e)
+		return 0;
+	format_datum_projjson(datum, body, year);
+	build_crs(&crs, e, body, year);
+	append_projjson(out, &crs, datum);
+	return sb_ok(out, datum);
+}
+
+/*------------------------------------------------------------------------------
+ * Input table reader
+ *
+ * Each line is split once, in place, into field views: separators are
+ * overwritten with '\0' and the fields point into the line buffer, so no
+ * row ever allocates.
+ *------------------------------------------------------------------------------
+*/
+
+enum {
+	FIELD_NAIF_ID,
+	FIELD_BODY,
+	FIELD_MEAN,
+	FIELD_SEMIMAJOR,
+	FIELD_AXISB,
+	FIELD_SEMIMINOR,
+	FIELD_COUNT
+};
+
+/*Split line on ',' and return the number of fields found*/
+static int split_fields(char * line, char * fields[], int maxFields)
+{
+	int n = 0;
+	char * p = line;
+
+	fields[n++] = p;
+	for (; *p; p++) {
+		if (*p == ',') {
+			*p = '\0';
+			if (n == maxFields)
+				break;
+			fields[n++] = p + 1;
+		} else if (*p == '\n' || *p == '\r') {
+			*p = '\0';
+			break;
+		}
+	}
+	return n;
+}
+
+/*Parse a whole field as a number, blank or malformed fields are rejected*/
+static int parse_number(const char * field, double * value)
+{
+	char * end;
+
+	while (*field == ' ' || *field == '\t')
+		field++;
+	if (*field == '\0')
+		return 0;
+	*value = strtod(field, &end);
+	if (end == field)
+		return 0;
+	while (*end == ' ' || *end == '\t')
+		end++;
+	return *end == '\0';
+}
+
+/*Parse a whole field as a base 10 integer*/
+static int parse_int(const char * field, int * value)
+{
+	char * end;
+	long v;
+
+	while (*field == ' ' || *field == '\t')
+		field++;
+	if (*field == '\0')
+		return 0;
+	v = strtol(field, &end, 10);
+	if (end == field)
+		return 0;
+	while (*end == ' ' || *end == '\t')
+		end++;
+	*value = (int)v;
+	return *end == '\0';
+}
+
+int iau_body_triaxial(const IauBody * body)
+{
+	return ((float)body->a != (float)body->b) && ((float)body->a != (float)body->c);
+}
+
+/*Double precision axes, with the same mean radius fallback as the WKT1*/
+static void set_axes(IauBody * body)
+{
+	body->semiMajor = body->a;
+	body->semiMinor = body->c;
+	if (iau_body_triaxial(body)) {
+		body->semiMajor = body->mean;
+		body->semiMinor = body->mean;
+	}
+}
+
+int iau_parse_row_status(char * line, IauBody * body)
+{
+	char * fields[FIELD_COUNT];
+	float theMean, theB, theC;
+
+	if (split_fields(line, fields, FIELD_COUNT) < FIELD_COUNT)
+		return IAU_ROW_SHORT;
+	if (!parse_int(fields[FIELD_NAIF_ID], &body->naifNum) || body->naifNum == 0)
+		return IAU_ROW_NAIF_ID;
+	/*Check that third token in line is not empty*/
+	if (!parse_number(fields[FIELD_MEAN], &body->mean) || body->mean == 0)
+		return IAU_ROW_MEAN;
+	if (!parse_number(fields[FIELD_SEMIMAJOR], &body->a)
+	|| !parse_number(fields[FIELD_AXISB], &body->b)
+	|| !parse_number(fields[FIELD_SEMIMINOR], &body->c))
+		return IAU_ROW_RADII;
+	body->target = fields[FIELD_BODY];
+
+	theMean = body->mean;
+	body->theA = body->a;
+	theB = body->b;
+	theC = body->c;
+	/*#Check to see if the Mean should be used, for triaxial bodies*/
+	if ((body->theA != theB) && (body->theA != theC))
+	{
+		body->theA = theMean;
+		theC = theMean;
+	}
+	body->flattening = ((body->theA - theC) / body->theA);
+	if (body->flattening < 0.0000000001
+	&& body->flattening > -0.0000000001
+	&& body->flattening != 0.0)
+	{
+		/*Inverse flattening if too small*/
+		body->flattening = 1.0 / body->flattening;
+	}
+	set_axes(body);
+	return IAU_ROW_OK;
+}
+
+int iau_parse_row(char * line, IauBody * body)
+{
+	return iau_parse_row_status(line, body) == IAU_ROW_OK;
+}
+
+int iau_year_from_filename(const char * path)
+{
+	/*Same as splitting on "U." with strtok and keeping the second token*/
+	const char * p = path;
+	int count = 0;
+
+	while (*p) {
+		while (*p == 'U' || *p == '.')
+			p++;
+		if (!*p)
+			break;
+		if (count == 1)
+			return atoi(p);
+		while (*p && *p != 'U' && *p != '.')
+			p++;
+		count++;
+	}
+	return 0;
+}
+
+/*------------------------------------------------------------------------------
+ * Streaming reader and writer
+ *
+ * The reader pulls input with read(2) into a growable buffer and hands out
+ * lines in place, with no length limit. The writer collects output in a
+ * large buffer written with write(2) once it holds flushSize bytes, or
+ * explicitly, e.g. before the reader has to wait for more input.
+ *------------------------------------------------------------------------------
+*/
+
+#define READER_CHUNK 65536
+
+void iau_reader_init(IauReader * r, int fd)
+{
+	memset(r, 0, sizeof(*r));
+	r->fd = fd;
+}
+
+void iau_reader_free(IauReader * r)
+{
+	count_free(r->data);
+	r->data = NULL;
+	r->cap = r->start = r->end = 0;
+}
+
+int iau_reader_would_block(const IauReader * r)
+{
+	struct pollfd pfd;
+
+	if (r->eof || (r->end > r->start && memchr(r->data + r->start, '\n', r->end - r->start)))
+		return 0;
+	pfd.fd = r->fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, 0) == 0;
+}
+
+char * iau_reader_line(IauReader * r)
+{
+	char * line;
+	char * nl;
+	ssize_t n;
+
+	for (;;) {
+		nl = r->end > r->start ? memchr(r->data + r->start, '\n', r->end - r->start) : NULL;
+		if (nl || (r->eof && r->start < r->end))
+			break;
+		if (r->eof)
+			return NULL;
+		/*Keep the partial line at the start, then make room for more*/
+		if (r->start) {
+			memmove(r->data, r->data + r->start, r->end - r->start);
+			r->end -= r->start;
+			r->start = 0;
+		}
+		if (r->cap - r->end < READER_CHUNK + 1) {
+			size_t cap = r->cap ? r->cap * 2 : READER_CHUNK * 2;
+			char * data = count_realloc(r->data, cap);
+			if (!data) {
+				r->error = 1;
+				r->eof = 1;
+				return NULL;
+			}
+			r->data = data;
+			r->cap = cap;
+		}
+		n = read(r->fd, r->data + r->end, r->cap - r->end - 1);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			r->error = 1;
+		if (n <= 0)
+			r->eof = 1;
+		else
+			r->end += (size_t)n;
+	}
+	line = r->data + r->start;
+	if (nl) {
+		*nl = '\0';
+		r->start = (size_t)(nl - r->data) + 1;
+	} else {
+		/*Last line without a newline, there is room for the terminator*/
+		r->data[r->end] = '\0';
+		r->start = r->end;
+	}
+	return line;
+}
+
+void iau_writer_init(IauWriter * w, int fd, size_t flushSize)
+{
+	memset(w, 0, sizeof(*w));
+	w->fd = fd;
+	w->flushSize = flushSize;
+}
+
+int iau_writer_flush(IauWriter * w)
+{
+	size_t off = 0;
+	ssize_t n;
+
+	if (w->buf.error)
+		w->error = 1;
+	while (off < w->buf.len && !w->error) {
+		n = write(w->fd, w->buf.data + off, w->buf.len - off);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			w->error = 1;
+		else
+			off += (size_t)n;
+	}
+	w->written += off;
+	w->buf.len = 0;
+	return !w->error;
+}
+
+int iau_writer_commit(IauWriter * w)
+{
+	if (w->buf.error)
+		w->error = 1;
+	if (w->buf.len >= w->flushSize)
+		return iau_writer_flush(w);
+	return !w->error;
+}
+
+int iau_writer_close(IauWriter * w)
+{
+	int ok = iau_writer_flush(w);
+
+	iau_buf_free(&w->buf);
+	return ok;
+}
+
+/*------------------------------------------------------------------------------
+ * Files replaced atomically
+ *------------------------------------------------------------------------------
+*/
+
+int iau_aside_open(IauAside * a, const char * path)
+{
+	memset(a, 0, sizeof(*a));
+	a->path = path;
+	iau_buf_printf(&a->tmp, "%s.tmp", path);
+	if (!a->tmp.error)
+		a->stream = fopen(a->tmp.data, "wb");
+	if (!a->stream) {
+		iau_buf_free(&a->tmp);
+		return 0;
+	}
+	return 1;
+}
+
+int iau_aside_close(IauAside * a, int ok)
+{
+	int err;
+
+	if (fclose(a->stream) != 0)
+		ok = 0;
+	if (ok && rename(a->tmp.data, a->path) != 0)
+		ok = 0;
+	if (!ok) {
+		err = errno;
+		unlink(a->tmp.data);
+		errno = err;
+	}
+	iau_buf_free(&a->tmp);
+	a->stream = NULL;
+	return ok;
+}
+
+/*------------------------------------------------------------------------------
+ * Body registry
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct {
+	int naifNum;
+	size_t index;
+} NaifIndex;
+
+struct IauRegistry {
+	int year;
+	IauBody * bodies;	/*In input order*/
+	size_t count;
+	NaifIndex * byNaif;	/*Sorted by NAIF id, then input order*/
+	IauEllipsoid * ellipsoids;	/*Parallel to bodies*/
+	size_t rows[IAU_ROW_STATUS_COUNT];	/*Table rows by parse outcome*/
+};
+
+void iau_ellipsoid_init(IauEllipsoid * e, const IauBody * body)
+{
+	double ratio = body->semiMinor / body->semiMajor;
+
+	e->naifNum = body->naifNum;
+	e->a = body->semiMajor;
+	e->b = body->semiMinor;
+	e->toCentric = ratio * ratio;
+	e->toGraphic = 1.0 / e->toCentric;
+}
+
+static int cmp_naif(const void * pa, const void * pb)
+{
+	const NaifIndex * a = pa;
+	const NaifIndex * b = pb;
+
+	if (a->naifNum != b->naifNum)
+		return a->naifNum < b->naifNum ? -1 : 1;
+	return a->index < b->index ? -1 : 1;
+}
+
+IauRegistry * iau_registry_load(const char * path, int year)
+{
+	FILE * stream;
+	IauRegistry * reg;
+
+	if (!year)
+		year = iau_year_from_filename(path);
+	if (!year)
+		return NULL;
+	stream = fopen(path, "r");
+	if (!stream)
+		return NULL;
+	reg = iau_registry_read(stream, year);
+	fclose(stream);
+	return reg;
+}
+
+IauRegistry * iau_registry_read(FILE * stream, int year)
+{
+	IauRegistry * reg;
+	char line[4096];
+	size_t cap = 0, i;
+	IauBody body;
+
+	reg = count_calloc(1, sizeof(*reg));
+	if (!reg)
+		return NULL;
+	reg->year = year;
+	while (fgets(line, sizeof(line), stream))
+	{
+		int rowStatus = iau_parse_row_status(line, &body);
+		reg->rows[rowStatus]++;
+		if (rowStatus != IAU_ROW_OK)
+			continue;
+		if (reg->count == cap) {
+			IauBody * bodies;
+			cap = cap ? cap * 2 : 256;
+			bodies = count_realloc(reg->bodies, cap * sizeof(*bodies));
+			if (!bodies)
+				goto fail;
+			reg->bodies = bodies;
+		}
+		body.target = count_strdup(body.target);
+		if (!body.target)
+			goto fail;
+		reg->bodies[reg->count++] = body;
+	}
+	if (ferror(stream))
+		goto fail;
+
+	reg->byNaif = count_malloc((reg->count ? reg->count : 1) * sizeof(NaifIndex));
+	if (!reg->byNaif)
+		goto fail;
+	for (i = 0; i < reg->count; i++) {
+		reg->byNaif[i].naifNum = reg->bodies[i].naifNum;
+		reg->byNaif[i].index = i;
+	}
+	qsort(reg->byNaif, reg->count, sizeof(NaifIndex), cmp_naif);
+	reg->ellipsoids = count_malloc((reg->count ? reg->count : 1) * sizeof(IauEllipsoid));
+	if (!reg->ellipsoids)
+		goto fail;
+	for (i = 0; i < reg->count; i++)
+		iau_ellipsoid_init(&reg->ellipsoids[i], &reg->bodies[i]);
+	return reg;
+
+fail:
+	iau_registry_free(reg);
+	return NULL;
+}
+
+void iau_registry_free(IauRegistry * reg)
+{
+	size_t i;
+
+	if (!reg)
+		return;
+	for (i = 0; i < reg->count; i++)
+		count_free((char *)reg->bodies[i].target);
+	count_free(reg->bodies);
+	count_free(reg->byNaif);
+	count_free(reg->ellipsoids);
+	count_free(reg);
+}
+
+int iau_registry_year(const IauRegistry * reg)
+{
+	return reg->year;
+}
+
+size_t iau_registry_count(const IauRegistry * reg)
+{
+	return reg->count;
+}
+
+const IauBody * iau_registry_body(const IauRegistry * reg, size_t i)
+{
+	return i < reg->count ? &reg->bodies[i] : NULL;
+}
+
+/*First entry of a sorted index with naifNum, NULL if there is none*/
+static const NaifIndex * find_naif(const NaifIndex * byNaif, size_t count, int naifNum)
+{
+	size_t lo = 0, hi = count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (byNaif[mid].naifNum < naifNum)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < count && byNaif[lo].naifNum == naifNum)
+		return &byNaif[lo];
+	return NULL;
+}
+
+/*First body of the table with this NAIF id*/
+const IauBody * iau_registry_find(const IauRegistry * reg, int naifNum)
+{
+	const NaifIndex * n = find_naif(reg->byNaif, reg->count, naifNum);
+	return n ? &reg->bodies[n->index] : NULL;
+}
+
+static unsigned int hash_code(int year, int code)
+{
+	unsigned int h = (unsigned int)code * 2654435761u;
+	return h ^ ((unsigned int)year * 40503u);
+}
+
+/*------------------------------------------------------------------------------
+ * Parallel batch writer
+ *
+ * The bodies of all batches are cut into chunks of consecutive rows that
+ * workers format into their own buffers. The calling thread writes the
+ * chunks strictly in input order as they complete, so the files are the
+ * same as a serial run. Workers stay at most a window of chunks ahead of
+ * the writer, which bounds the memory held by formatted output.
+ *------------------------------------------------------------------------------
+*/
+
+#define BATCH_CHUNK_BODIES 32
+
+typedef struct {
+	const IauBatch * batch;
+	size_t first, count;	/*Bodies of batch->reg*/
+	IauBuf wkt, proj4, wkt2, projjson, dict;
+	int done;
+} BatchChunk;
+
+typedef struct {
+	BatchChunk * chunks;
+	size_t nChunks;
+	size_t next;		/*Next chunk to hand to a worker*/
+	size_t written;		/*Chunks already written out*/
+	size_t window;
+	size_t bytes;		/*Written so far, by the calling thread only*/
+	double writeSeconds;
+	pthread_mutex_t lock;
+	pthread_cond_t doneCond;
+	pthread_cond_t spaceCond;
+} BatchQueue;
+
+/*Per worker scratch buffers of the body fragments*/
+typedef struct {
+	IauBuf geogcs, ellps, datum;
+} BatchScratch;
+
+static void free_scratch(BatchScratch * s)
+{
+	iau_buf_free(&s->geogcs);
+	iau_buf_free(&s->ellps);
+	iau_buf_free(&s->datum);
+}
+
+static void format_chunk(BatchChunk * c, BatchScratch * s)
+{
+	const IauRegistry * reg = c->batch->reg;
+	size_t i;
+
+	for (i = c->first; i < c->first + c->count; i++) {
+		if (c->batch->wkt)
+			iau_format_body(&c->wkt, &s->geogcs, &reg->bodies[i], reg->year);
+		if (c->batch->proj4)
+			iau_format_body_proj4(&c->proj4, &s->ellps, &reg->bodies[i]);
+		if (c->batch->wkt2)
+			iau_format_body_wkt2(&c->wkt2, &s->datum, &reg->bodies[i], reg->year);
+		if (c->batch->projjson)
+			iau_format_body_projjson(&c->projjson, &s->datum, &reg->bodies[i], reg->year);
+		if (c->batch->dict)
+			iau_format_body_dict(&c->dict, &s->geogcs, &reg->bodies[i], reg->year);
+	}
+}
+
+static void * batch_worker(void * arg)
+{
+	BatchQueue * q = arg;
+	BatchScratch s;
+	size_t c;
+
+	memset(&s, 0, sizeof(s));
+
+	pthread_mutex_lock(&q->lock);
+	for (;;) {
+		while (q->next < q->nChunks && q->next >= q->written + q->window)
+			pthread_cond_wait(&q->spaceCond, &q->lock);
+		if (q->next >= q->nChunks)
+			break;
+		c = q->next++;
+		pthread_mutex_unlock(&q->lock);
+
+		format_chunk(&q->chunks[c], &s);
+
+		pthread_mutex_lock(&q->lock);
+		q->chunks[c].done = 1;
+		pthread_cond_broadcast(&q->doneCond);
+	}
+	pthread_mutex_unlock(&q->lock);
+	free_scratch(&s);
+	return NULL;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int write_buf(IauBuf * buf, FILE * f, size_t * bytes)
+{
+	int ok = !f || (!buf->error && (!buf->len || fwrite(buf->data, 1, buf->len, f) == buf->len));
+	if (f && ok)
+		*bytes += buf->len;
+	iau_buf_free(buf);
+	return ok;
+}
+
+static int write_chunk(BatchQueue * q, BatchChunk * c)
+{
+	double t0 = now();
+	int ok = 1;
+
+	ok &= write_buf(&c->wkt, c->batch->wkt, &q->bytes);
+	ok &= write_buf(&c->proj4, c->batch->proj4, &q->bytes);
+	ok &= write_buf(&c->wkt2, c->batch->wkt2, &q->bytes);
+	ok &= write_buf(&c->projjson, c->batch->projjson, &q->bytes);
+	ok &= write_buf(&c->dict, c->batch->dict, &q->bytes);
+	q->writeSeconds += now() - t0;
+	return ok;
+}
+
+static int write_serial(BatchQueue * q)
+{
+	BatchScratch s;
+	int ok = 1;
+	size_t c;
+
+	memset(&s, 0, sizeof(s));
+	for (c = 0; c < q->nChunks; c++) {
+		format_chunk(&q->chunks[c], &s);
+		ok &= write_chunk(q, &q->chunks[c]);
+	}
+	free_scratch(&s);
+	return ok;
+}
+
+/*Add the bodies, bytes and times of a finished run to stats*/
+static void batch_stats(const BatchQueue * q, const IauBatch * batches, int nBatches,
+	double seconds, IauStats * stats)
+{
+	size_t i;
+	int b;
+
+	if (!stats)
+		return;
+	for (b = 0; b < nBatches; b++) {
+		stats->bodies += batches[b].reg->count;
+		for (i = 0; i < batches[b].reg->count; i++)
+			stats->triaxial += iau_body_triaxial(&batches[b].reg->bodies[i]);
+	}
+	stats->bytes += q->bytes;
+	stats->seconds[IAU_STAGE_WRITE] += q->writeSeconds;
+	stats->seconds[IAU_STAGE_FORMAT] += seconds - q->writeSeconds;
+}
+
+int iau_write_batches(const IauBatch * batches, int nBatches, int nThreads)
+{
+	return iau_write_batches_stats(batches, nBatches, nThreads, NULL);
+}
+
+int iau_write_batches_stats(const IauBatch * batches, int nBatches, int nThreads, IauStats * stats)
+{
+	BatchQueue q;
+	pthread_t * threads = NULL;
+	int nStarted = 0;
+	int ok = 1;
+	size_t c, i;
+	int b;
+	double t0 = now();
+
+	memset(&q, 0, sizeof(q));
+	for (b = 0; b < nBatches; b++)
+		q.nChunks += (batches[b].reg->count + BATCH_CHUNK_BODIES - 1) / BATCH_CHUNK_BODIES;
+	q.chunks = count_calloc(q.nChunks ? q.nChunks : 1, sizeof(*q.chunks));
+	if (!q.chunks)
+		return 0;
+	c = 0;
+	for (b = 0; b < nBatches; b++) {
+		for (i = 0; i < batches[b].reg->count; i += BATCH_CHUNK_BODIES) {
+			q.chunks[c].batch = &batches[b];
+			q.chunks[c].first = i;
+			q.chunks[c].count = batches[b].reg->count - i < BATCH_CHUNK_BODIES
+				? batches[b].reg->count - i : BATCH_CHUNK_BODIES;
+			c++;
+		}
+	}
+
+	if (nThreads <= 1) {
+		ok = write_serial(&q);
+		batch_stats(&q, batches, nBatches, now() - t0, stats);
+		count_free(q.chunks);
+		return ok;
+	}
+
+	q.window = (size_t)nThreads * 4;
+	pthread_mutex_init(&q.lock, NULL);
+	pthread_cond_init(&q.doneCond, NULL);
+	pthread_cond_init(&q.spaceCond, NULL);
+	threads = count_malloc(nThreads * sizeof(*threads));
+	if (threads)
+		for (; nStarted < nThreads; nStarted++)
+			if (pthread_create(&threads[nStarted], NULL, batch_worker, &q) != 0)
+				break;
+	if (!nStarted) {
+		/*No worker could start, format from this thread instead*/
+		ok = write_serial(&q);
+	} else {
+		for (c = 0; c < q.nChunks; c++) {
+			pthread_mutex_lock(&q.lock);
+			while (!q.chunks[c].done)
+				pthread_cond_wait(&q.doneCond, &q.lock);
+			pthread_mutex_unlock(&q.lock);
+
+			ok &= write_chunk(&q, &q.chunks[c]);
+
+			pthread_mutex_lock(&q.lock);
+			q.written = c + 1;
+			pthread_cond_broadcast(&q.spaceCond);
+			pthread_mutex_unlock(&q.lock);
+		}
+		while (nStarted)
+			pthread_join(threads[--nStarted], NULL);
+	}
+	count_free(threads);
+	batch_stats(&q, batches, nBatches, now() - t0, stats);
+	pthread_cond_destroy(&q.spaceCond);
+	pthread_cond_destroy(&q.doneCond);
+	pthread_mutex_destroy(&q.lock);
+	count_free(q.chunks);
+	return ok;
+}
+
+/*------------------------------------------------------------------------------
+ * Prebuilt code registry file
+ *
+ * Every definition of a table is built once and written with its body
+ * parameters to a binary file that readers mmap read-only, so worker
+ * processes share its pages and answer lookups without any parsing:
+ *
+ *   MapHeader
+ *   MapBody[bodyCount]	sorted by NAIF id
+ *   MapCode[codeCount]	sorted by code
+ *   uint32[slotCount]	open addressing hash of codes, index + 1, 0 = empty
+ *   blob			NUL terminated body names and WKT strings
+ *
+ * Integers are stored in host byte order, checked through byteOrder.
+ *------------------------------------------------------------------------------
+*/
+
+#define MAP_MAGIC "IAUWKTRG"
+#define MAP_VERSION 1
+#define MAP_BYTE_ORDER 0x01020304u
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	int32_t year;
+	uint32_t bodyCount;
+	uint32_t codeCount;
+	uint32_t slotCount;	/*Power of two*/
+	uint64_t bodiesOffset;
+	uint64_t codesOffset;
+	uint64_t slotsOffset;
+	uint64_t blobOffset;
+	uint64_t fileSize;
+} MapHeader;
+
+typedef struct {
+	int32_t naifNum;
+	uint32_t nameOffset;	/*Into the blob*/
+	double mean, a, b, c;
+	float theA, flattening;
+} MapBody;
+
+typedef struct {
+	int32_t code;
+	uint32_t body;		/*Index into the MapBody array*/
+	uint32_t wktOffset;	/*Into the blob*/
+	uint32_t wktLen;
+} MapCode;
+
+struct IauMap {
+	void * base;
+	size_t size;
+	const MapHeader * header;
+	const MapBody * bodies;
+	const MapCode * codes;
+	const uint32_t * slots;
+	const char * blob;
+};
+
+static size_t align8(size_t n)
+{
+	return (n + 7) & ~(size_t)7;
+}
+
+static int write_all(FILE * f, const void * data, size_t n, size_t * pos)
+{
+	static const char zeros[8];
+	size_t padded = align8(*pos + n) - *pos - n;
+
+	if (n && fwrite(data, 1, n, f) != n)
+		return 0;
+	if (padded && fwrite(zeros, 1, padded, f) != padded)
+		return 0;
+	*pos += n + padded;
+	return 1;
+}
+
+int iau_registry_write_map(const IauRegistry * reg, const char * path)
+{
+	MapHeader h;
+	MapBody * bodies = NULL;
+	MapCode * codes = NULL;
+	uint32_t * slots = NULL;
+	IauBuf blob = {NULL, 0, 0, 0};
+	IauBuf geogcs = {NULL, 0, 0, 0};
+	size_t nBodies = 0, nCodes = 0, pos = 0, i;
+	uint32_t nSlots = 1;
+	IauAside file;
+	int ok = 0;
+	int k;
+
+	bodies = count_malloc((reg->count ? reg->count : 1) * sizeof(*bodies));
+	codes = count_malloc((reg->count ? reg->count : 1) * ENTRY_COUNT * sizeof(*codes));
+	if (!bodies || !codes)
+		goto done;
+
+	/*First body wins when a NAIF id is repeated, as in iau_registry_find*/
+	for (i = 0; i < reg->count; i++) {
+		const IauBody * body = &reg->bodies[reg->byNaif[i].index];
+		MapBody * mb;
+
+		if (nBodies && bodies[nBodies - 1].naifNum == body->naifNum)
+			continue;
+		mb = &bodies[nBodies];
+		memset(mb, 0, sizeof(*mb));
+		mb->naifNum = body->naifNum;
+		mb->nameOffset = (uint32_t)blob.len;
+		sb_append(&blob, body->target, strlen(body->target) + 1);
+		mb->mean = body->mean;
+		mb->a = body->a;
+		mb->b = body->b;
+		mb->c = body->c;
+		mb->theA = body->theA;
+		mb->flattening = body->flattening;
+
+		iau_format_geogcs(&geogcs, body, reg->year);
+		for (k = 0; k < ENTRY_COUNT; k++) {
+			MapCode * mc = &codes[nCodes++];
+			mc->code = body->naifNum * 100 + entries[k].offset;
+			mc->body = (uint32_t)nBodies;
+			mc->wktOffset = (uint32_t)blob.len;
+			append_wkt(&blob, &entries[k], body->target, mc->code, reg->year, &geogcs);
+			mc->wktLen = (uint32_t)(blob.len - mc->wktOffset);
+			sb_append(&blob, "", 1);
+		}
+		nBodies++;
+	}
+	if (!sb_ok(&blob, &geogcs) || blob.len > UINT32_MAX)
+		goto done;
+
+	while (nSlots < nCodes * 2)
+		nSlots <<= 1;
+	slots = count_calloc(nSlots, sizeof(*slots));
+	if (!slots)
+		goto done;
+	for (i = 0; i < nCodes; i++) {
+		uint32_t s = hash_code(0, codes[i].code) & (nSlots - 1);
+		while (slots[s])
+			s = (s + 1) & (nSlots - 1);
+		slots[s] = (uint32_t)i + 1;
+	}
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, MAP_MAGIC, sizeof(h.magic));
+	h.version = MAP_VERSION;
+	h.byteOrder = MAP_BYTE_ORDER;
+	h.year = reg->year;
+	h.bodyCount = (uint32_t)nBodies;
+	h.codeCount = (uint32_t)nCodes;
+	h.slotCount = nSlots;
+	h.bodiesOffset = align8(sizeof(h));
+	h.codesOffset = h.bodiesOffset + align8(nBodies * sizeof(*bodies));
+	h.slotsOffset = h.codesOffset + align8(nCodes * sizeof(*codes));
+	h.blobOffset = h.slotsOffset + align8(nSlots * sizeof(*slots));
+	h.fileSize = h.blobOffset + align8(blob.len);
+
+	/*Readers keep the previous file mapped*/
+	if (!iau_aside_open(&file, path))
+		goto done;
+	ok = write_all(file.stream, &h, sizeof(h), &pos)
+		&& write_all(file.stream, bodies, nBodies * sizeof(*bodies), &pos)
+		&& write_all(file.stream, codes, nCodes * sizeof(*codes), &pos)
+		&& write_all(file.stream, slots, nSlots * sizeof(*slots), &pos)
+		&& write_all(file.stream, blob.data, blob.len, &pos);
+	ok = iau_aside_close(&file, ok);
+
+done:
+	count_free(bodies);
+	count_free(codes);
+	count_free(slots);
+	iau_buf_free(&blob);
+	iau_buf_free(&geogcs);
+	return ok;
+}
+
+/*A table of count entries of the given size starting at off lies past the
+ *header and inside the file, computed by subtraction so that no sum wraps*/
+static int map_table_fits(const MapHeader * h, uint64_t off, uint64_t count, size_t size)
+{
+	return off >= sizeof(MapHeader) && off <= h->fileSize
+		&& count <= (h->fileSize - off) / size;
+}
+
+/*Check every offset and index of a mapped file against its tables, so
+ *that lookups never read outside the mapping*/
+static int map_valid(const char * base, size_t size)
+{
+	const MapHeader * h = (const MapHeader *)base;
+	const MapBody * bodies;
+	const MapCode * codes;
+	const uint32_t * slots;
+	const char * blob;
+	uint64_t blobSize;
+	uint32_t i, used = 0;
+
+	if (memcmp(h->magic, MAP_MAGIC, sizeof(h->magic)) != 0
+	|| h->version != MAP_VERSION
+	|| h->byteOrder != MAP_BYTE_ORDER
+	|| h->fileSize != (uint64_t)size
+	|| (h->bodiesOffset | h->codesOffset | h->slotsOffset) & 7
+	|| !map_table_fits(h, h->bodiesOffset, h->bodyCount, sizeof(MapBody))
+	|| !map_table_fits(h, h->codesOffset, h->codeCount, sizeof(MapCode))
+	|| !map_table_fits(h, h->slotsOffset, h->slotCount, sizeof(uint32_t))
+	|| !map_table_fits(h, h->blobOffset, 0, 1)
+	|| h->slotCount == 0 || (h->slotCount & (h->slotCount - 1)) != 0
+	|| h->slotCount <= h->codeCount)
+		return 0;
+	bodies = (const MapBody *)(base + h->bodiesOffset);
+	codes = (const MapCode *)(base + h->codesOffset);
+	slots = (const uint32_t *)(base + h->slotsOffset);
+	blob = base + h->blobOffset;
+	blobSize = h->fileSize - h->blobOffset;
+
+	/*Names and definitions are NUL terminated inside the blob*/
+	for (i = 0; i < h->bodyCount; i++)
+		if (bodies[i].nameOffset >= blobSize
+		|| !memchr(blob + bodies[i].nameOffset, '\0', blobSize - bodies[i].nameOffset))
+			return 0;
+	for (i = 0; i < h->codeCount; i++)
+		if (codes[i].body >= h->bodyCount
+		|| (uint64_t)codes[i].wktOffset + codes[i].wktLen >= blobSize
+		|| blob[codes[i].wktOffset + codes[i].wktLen] != '\0')
+			return 0;
+	/*At least one empty slot ends every probe sequence*/
+	for (i = 0; i < h->slotCount; i++) {
+		if (slots[i] > h->codeCount)
+			return 0;
+		used += slots[i] != 0;
+	}
+	return used < h->slotCount;
+}
+
+IauMap * iau_map_open(const char * path)
+{
+	struct stat st;
+	const MapHeader * h;
+	IauMap * map;
+	void * base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MapHeader)) {
+		close(fd);
+		return NULL;
+	}
+	base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return NULL;
+
+	h = base;
+	if (!map_valid(base, (size_t)st.st_size)) {
+		munmap(base, (size_t)st.st_size);
+		return NULL;
+	}
+
+	map = count_malloc(sizeof(*map));
+	if (!map) {
+		munmap(base, (size_t)st.st_size);
+		return NULL;
+	}
+	map->base = base;
+	map->size = (size_t)st.st_size;
+	map->header = h;
+	map->bodies = (const MapBody *)((const char *)base + h->bodiesOffset);
+	map->codes = (const MapCode *)((const char *)base + h->codesOffset);
+	map->slots = (const uint32_t *)((const char *)base + h->slotsOffset);
+	map->blob = (const char *)base + h->blobOffset;
+	return map;
+}
+
+void iau_map_close(IauMap * map)
+{
+	if (!map)
+		return;
+	munmap(map->base, map->size);
+	count_free(map);
+}
+
+int iau_map_year(const IauMap * map)
+{
+	return map->header->year;
+}
+
+static const MapCode * map_code(const IauMap * map, int code)
+{
+	uint32_t mask = map->header->slotCount - 1;
+	uint32_t s = hash_code(0, code) & mask;
+
+	for (; map->slots[s]; s = (s + 1) & mask)
+		if (map->codes[map->slots[s] - 1].code == code)
+			return &map->codes[map->slots[s] - 1];
+	return NULL;
+}
+
+const char * iau_map_find(const IauMap * map, int code, size_t * len)
+{
+	const MapCode * mc = map_code(map, code);
+
+	if (!mc)
+		return NULL;
+	if (len)
+		*len = mc->wktLen;
+	return map->blob + mc->wktOffset;
+}
+
+int iau_map_body(const IauMap * map, int code, IauBody * body)
+{
+	const MapCode * mc = map_code(map, code);
+	const MapBody * mb;
+
+	if (!mc)
+		return 0;
+	mb = &map->bodies[mc->body];
+	body->naifNum = mb->naifNum;
+	body->target = map->blob + mb->nameOffset;
+	body->mean = mb->mean;
+	body->a = mb->a;
+	body->b = mb->b;
+	body->c = mb->c;
+	body->theA = mb->theA;
+	body->flattening = mb->flattening;
+	set_axes(body);
+	return 1;
+}
+
+/*------------------------------------------------------------------------------
+ * Code lookup with an LRU cache of built definitions
+ *
+ * Cache slots live in one array, chained into hash buckets by (year, code)
+ * and into a most to least recently used list. A miss reuses the least
+ * recently used slot, its buffer included.
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct {
+	int year;
+	int code;
+	IauBuf wkt;
+	size_t lonAt, lonLen;	/*AUTO codes: value of the central longitude,*/
+	size_t latAt, latLen;	/*and of the center latitude (latLen 0 if none)*/
+	int prev, next;		/*LRU list, -1 terminated*/
+	int chain;		/*Next slot in the same hash bucket, -1 terminated*/
+} CacheSlot;
+
+struct IauLookup {
+	IauRegistry ** registries;
+	int registryCount;
+	IauMap ** maps;
+	int mapCount;
+	IauDict ** dicts;
+	int dictCount;
+	CacheSlot * slots;
+	int capacity;
+	int used;
+	int * buckets;
+	unsigned int bucketMask;
+	int head, tail;		/*Most and least recently used slots*/
+	IauBuf geogcs;
+	IauBuf expanded;	/*Dictionary definition before it enters the cache*/
+};
+
+IauLookup * iau_lookup_new(size_t cacheSize)
+{
+	IauLookup * lk;
+	unsigned int nBuckets = 1;
+	unsigned int i;
+
+	if (cacheSize < 1)
+		cacheSize = 1;
+	while (nBuckets < cacheSize * 2)
+		nBuckets <<= 1;
+	lk = count_calloc(1, sizeof(*lk));
+	if (!lk)
+		return NULL;
+	lk->slots = count_calloc(cacheSize, sizeof(CacheSlot));
+	lk->buckets = count_malloc(nBuckets * sizeof(int));
+	if (!lk->slots || !lk->buckets) {
+		iau_lookup_free(lk);
+		return NULL;
+	}
+	for (i = 0; i < nBuckets; i++)
+		lk->buckets[i] = -1;
+	lk->bucketMask = nBuckets - 1;
+	lk->capacity = (int)cacheSize;
+	lk->head = lk->tail = -1;
+	return lk;
+}
+
+void iau_lookup_free(IauLookup * lk)
+{
+	int i;
+
+	if (!lk)
+		return;
+	for (i = 0; i < lk->registryCount; i++)
+		iau_registry_free(lk->registries[i]);
+	count_free(lk->registries);
+	for (i = 0; i < lk->mapCount; i++)
+		iau_map_close(lk->maps[i]);
+	count_free(lk->maps);
+	for (i = 0; i < lk->dictCount; i++)
+		iau_dict_close(lk->dicts[i]);
+	count_free(lk->dicts);
+	if (lk->slots)
+		for (i = 0; i < lk->used; i++)
+			iau_buf_free(&lk->slots[i].wkt);
+	count_free(lk->slots);
+	count_free(lk->buckets);
+	iau_buf_free(&lk->geogcs);
+	iau_buf_free(&lk->expanded);
+	count_free(lk);
+}
+
+int iau_lookup_add(IauLookup * lk, IauRegistry * reg)
+{
+	IauRegistry ** registries;
+
+	registries = count_realloc(lk->registries, (lk->registryCount + 1) * sizeof(*registries));
+	if (!registries)
+		return 0;
+	lk->registries = registries;
+	lk->registries[lk->registryCount++] = reg;
+	return 1;
+}
+
+int iau_lookup_add_map(IauLookup * lk, IauMap * map)
+{
+	IauMap ** maps;
+
+	maps = count_realloc(lk->maps, (lk->mapCount + 1) * sizeof(*maps));
+	if (!maps)
+		return 0;
+	lk->maps = maps;
+	lk->maps[lk->mapCount++] = map;
+	return 1;
+}
+
+int iau_lookup_add_dict(IauLookup * lk, IauDict * d)
+{
+	IauDict ** dicts;
+
+	dicts = count_realloc(lk->dicts, (lk->dictCount + 1) * sizeof(*dicts));
+	if (!dicts)
+		return 0;
+	lk->dicts = dicts;
+	lk->dicts[lk->dictCount++] = d;
+	return 1;
+}
+
+static void lru_unlink(IauLookup * lk, int i)
+{
+	CacheSlot * s = &lk->slots[i];
+
+	if (s->prev >= 0)
+		lk->slots[s->prev].next = s->next;
+	else
+		lk->head = s->next;
+	if (s->next >= 0)
+		lk->slots[s->next].prev = s->prev;
+	else
+		lk->tail = s->prev;
+}
+
+static void lru_push_front(IauLookup * lk, int i)
+{
+	CacheSlot * s = &lk->slots[i];
+
+	s->prev = -1;
+	s->next = lk->head;
+	if (lk->head >= 0)
+		lk->slots[lk->head].prev = i;
+	lk->head = i;
+	if (lk->tail < 0)
+		lk->tail = i;
+}
+
+static void bucket_remove(IauLookup * lk, int i)
+{
+	int * link = &lk->buckets[hash_code(lk->slots[i].year, lk->slots[i].code) & lk->bucketMask];
+
+	while (*link != i)
+		link = &lk->slots[*link].chain;
+	*link = lk->slots[i].chain;
+}
+
+static int authority_year(const char * authority)
+{
+	if (strncmp(authority, "IAU", 3) != 0)
+		return 0;
+	return atoi(authority + 3);
+}
+
+/*Cached slot of code, made most recently used, -1 on a miss*/
+static int cache_find(IauLookup * lk, int year, int code)
+{
+	int i;
+
+	for (i = lk->buckets[hash_code(year, code) & lk->bucketMask]; i >= 0; i = lk->slots[i].chain) {
+		if (lk->slots[i].year == year && lk->slots[i].code == code) {
+			if (lk->head != i) {
+				lru_unlink(lk, i);
+				lru_push_front(lk, i);
+			}
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*Value of PARAMETER["name",value] in wkt*/
+static void find_parameter(const IauBuf * wkt, const char * name, size_t * at, size_t * len)
+{
+	char key[64];
+	const char * p;
+
+	*at = *len = 0;
+	snprintf(key, sizeof(key), "PARAMETER[\"%s\",", name);
+	p = strstr(wkt->data, key);
+	if (!p)
+		return;
+	*at = (size_t)(p - wkt->data) + strlen(key);
+	*len = strcspn(wkt->data + *at, "]");
+}
+
+/*Build code of body into the least recently used slot, or, body being
+ *NULL, take the definition already built in text (swapping buffers).
+ *-1 if the definition could not be built*/
+static int cache_insert(IauLookup * lk, int year, int code, const IauBody * body, IauBuf * text)
+{
+	const Entry * e = find_entry(code % 100);
+	unsigned int bucket;
+	int i, ok;
+
+	if (lk->used < lk->capacity) {
+		i = lk->used++;
+	} else {
+		i = lk->tail;
+		lru_unlink(lk, i);
+		bucket_remove(lk, i);
+	}
+	CacheSlot * s = &lk->slots[i];
+	s->year = year;
+	s->code = code;
+	if (body) {
+		s->wkt.len = 0;
+		ok = iau_format_code(&s->wkt, &lk->geogcs, body, year, code % 100);
+	} else {
+		IauBuf t = s->wkt;
+		s->wkt = *text;
+		*text = t;
+		ok = !s->wkt.error;
+	}
+	s->lonLen = s->latLen = 0;
+	if (!ok || !sb_cstr(&s->wkt)) {
+		/*Keep the slot linked, empty: no lookup asks for year 0*/
+		iau_buf_free(&s->wkt);
+		iau_buf_free(&lk->geogcs);
+		s->year = s->code = 0;
+	} else if (e->offset >= AUTO_FIRST_OFFSET) {
+		/*Template slots, located once*/
+		find_parameter(&s->wkt, families[e->family].center, &s->lonAt, &s->lonLen);
+		if (autoLatitude[e->family])
+			find_parameter(&s->wkt, autoLatitude[e->family], &s->latAt, &s->latLen);
+	}
+	bucket = hash_code(s->year, s->code) & lk->bucketMask;
+	s->chain = lk->buckets[bucket];
+	lk->buckets[bucket] = i;
+	lru_push_front(lk, i);
+	return s->year ? i : -1;
+}
+
+/*Cache slot of code expanded from a dictionary, -1 if none has it*/
+static int dict_expand_code(IauLookup * lk, int year, int code)
+{
+	int i;
+
+	for (i = 0; i < lk->dictCount; i++) {
+		if (iau_dict_year(lk->dicts[i]) != year)
+			continue;
+		if (lk->expanded.error)
+			iau_buf_free(&lk->expanded);
+		lk->expanded.len = 0;
+		if (iau_dict_find(lk->dicts[i], &lk->expanded, code))
+			return cache_insert(lk, year, code, NULL, &lk->expanded);
+		if (lk->expanded.error)
+			return -1;
+	}
+	return -1;
+}
+
+const char * iau_lookup(IauLookup * lk, const char * authority, int code)
+{
+	int year = authority_year(authority);
+	const IauBody * body = NULL;
+	int i;
+
+	if (!year)
+		return NULL;
+	/*Prebuilt definitions need no cache*/
+	for (i = 0; i < lk->mapCount; i++) {
+		if (iau_map_year(lk->maps[i]) == year) {
+			const char * wkt = iau_map_find(lk->maps[i], code, NULL);
+			if (wkt)
+				return wkt;
+		}
+	}
+	i = cache_find(lk, year, code);
+	if (i >= 0)
+		return lk->slots[i].wkt.data;
+
+	if (code % 100 < 0 || !find_entry(code % 100))
+		return NULL;
+	for (i = 0; i < lk->registryCount && !body; i++)
+		if (lk->registries[i]->year == year)
+			body = iau_registry_find(lk->registries[i], code / 100);
+	i = body ? cache_insert(lk, year, code, body, NULL) : dict_expand_code(lk, year, code);
+	return i >= 0 ? lk->slots[i].wkt.data : NULL;
+}
+
+const char * iau_lookup_string(IauLookup * lk, const char * request)
+{
+	char authority[32];
+	const char * colon = strchr(request, ':');
+	size_t n;
+
+	if (!colon)
+		return NULL;
+	n = (size_t)(colon - request);
+	if (n >= sizeof(authority))
+		return NULL;
+	memcpy(authority, request, n);
+	authority[n] = '\0';
+	return iau_lookup(lk, authority, atoi(colon + 1));
+}
+
+/*------------------------------------------------------------------------------
+ * Incremental regeneration
+ *
+ * A state file next to the output records, for every body block written,
+ * a hash of its input row, year and IAUWKT_FORMAT_VERSION together with
+ * where the block sits in the output and a hash of the block itself:
+ *
+ *   iauwkt-state <version> <year>
+ *   <naifNum> <row hash> <offset> <length> <block hash>	per block, in output order
+ *
+ * A row whose hash is found there has its previous block copied through,
+ * provided the block still hashes the same. Other rows are formatted, and
+ * their code lines compared with the previous block of the same body so
+ * that only codes whose definition actually differs are reported.
+ *------------------------------------------------------------------------------
+*/
+
+#define STATE_MAGIC "iauwkt-state"
+
+typedef struct {
+	int naifNum;
+	uint64_t rowHash;
+	size_t offset, length;
+	uint64_t blockHash;
+	int used;
+} StateBlock;
+
+typedef struct {
+	int code;
+	const char * text;	/*Whole "<code>,..." line, without newline*/
+	size_t len;
+} CodeLine;
+
+static uint64_t fnv1a(uint64_t h, const void * data, size_t n)
+{
+	const unsigned char * p = data;
+	while (n--) {
+		h ^= *p++;
+		h *= 0x100000001b3ull;
+	}
+	return h;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+
+static uint64_t hash_row(const char * line, size_t len, int year)
+{
+	int salt[2] = {IAUWKT_FORMAT_VERSION, year};
+	return fnv1a(fnv1a(FNV_OFFSET, salt, sizeof(salt)), line, len);
+}
+
+static int cmp_state_hash(const void * pa, const void * pb)
+{
+	const StateBlock * a = pa, * b = pb;
+	return a->rowHash < b->rowHash ? -1 : a->rowHash > b->rowHash;
+}
+
+/*Blocks of a state file within the previous output of size outSize. Those
+ *of another version are still compared against, their row hashes just
+ *never match*/
+static StateBlock * load_state(const char * path, size_t outSize, size_t * count)
+{
+	FILE * f = fopen(path, "r");
+	StateBlock * blocks = NULL, b;
+	size_t cap = 0;
+	int version, year;
+	unsigned long long rowHash, blockHash, offset, length;
+
+	*count = 0;
+	if (!f)
+		return NULL;
+	if (fscanf(f, STATE_MAGIC " %d %d", &version, &year) != 2) {
+		fclose(f);
+		return NULL;
+	}
+	memset(&b, 0, sizeof(b));
+	while (fscanf(f, "%d %llx %llu %llu %llx", &b.naifNum, &rowHash, &offset, &length, &blockHash) == 5) {
+		if (offset > outSize || length > outSize - offset)
+			continue;
+		if (*count == cap) {
+			StateBlock * grown;
+			cap = cap ? cap * 2 : 256;
+			grown = count_realloc(blocks, cap * sizeof(*blocks));
+			if (!grown)
+				break;
+			blocks = grown;
+		}
+		b.rowHash = rowHash;
+		b.blockHash = blockHash;
+		b.offset = (size_t)offset;
+		b.length = (size_t)length;
+		blocks[(*count)++] = b;
+	}
+	fclose(f);
+	return blocks;
+}
+
+/*The "<code>,..." lines of a code block into *lines, their count into
+ **count. Returns 0 if the array could not grow*/
+static int code_lines(const char * block, size_t len, CodeLine ** lines, size_t * cap, size_t * count)
+{
+	const char * p = block, * end = block + len;
+	size_t n = 0;
+
+	while (p < end) {
+		const char * eol = memchr(p, '\n', end - p);
+		if (!eol)
+			eol = end;
+		if (*p >= '0' && *p <= '9') {
+			if (n == *cap) {
+				size_t grownCap = *cap ? *cap * 2 : 64;
+				CodeLine * grown = count_realloc(*lines, grownCap * sizeof(**lines));
+				if (!grown)
+					return 0;
+				*lines = grown;
+				*cap = grownCap;
+			}
+			(*lines)[n].code = atoi(p);
+			(*lines)[n].text = p;
+			(*lines)[n].len = eol - p;
+			n++;
+		}
+		p = eol + 1;
+	}
+	*count = n;
+	return 1;
+}
+
+static void report_code(FILE * changes, int year, int code, const char * what, size_t * counter)
+{
+	(*counter)++;
+	if (changes)
+		fprintf(changes, "IAU%d:%d %s\n", year, code, what);
+}
+
+typedef struct {
+	CodeLine * oldLines, * newLines;
+	size_t oldCap, newCap;
+} DiffScratch;
+
+/*Report the codes of newBlock (NULL if the body is gone) that differ from
+ *oldBlock (NULL if the body is new). Returns 0 if memory ran out*/
+static int diff_blocks(const char * oldBlock, size_t oldLen, const char * newBlock, size_t newLen,
+	int year, FILE * changes, IauUpdateStats * stats, DiffScratch * d)
+{
+	size_t nOld = 0, nNew = 0;
+	size_t i, j;
+
+	if ((oldBlock && !code_lines(oldBlock, oldLen, &d->oldLines, &d->oldCap, &nOld))
+	|| (newBlock && !code_lines(newBlock, newLen, &d->newLines, &d->newCap, &nNew)))
+		return 0;
+
+	for (i = 0; i < nNew; i++) {
+		const CodeLine * n = &d->newLines[i];
+		for (j = 0; j < nOld && d->oldLines[j].code != n->code; j++)
+			;
+		if (j == nOld)
+			report_code(changes, year, n->code, "added", &stats->codesAdded);
+		else if (d->oldLines[j].len != n->len || memcmp(d->oldLines[j].text, n->text, n->len) != 0)
+			report_code(changes, year, n->code, "changed", &stats->codesChanged);
+	}
+	for (j = 0; j < nOld; j++) {
+		for (i = 0; i < nNew && d->newLines[i].code != d->oldLines[j].code; i++)
+			;
+		if (i == nNew)
+			report_code(changes, year, d->oldLines[j].code, "removed", &stats->codesRemoved);
+	}
+	return 1;
+}
+
+/*fwrite of len bytes. Returns 0 on error*/
+static int write_data(FILE * f, const char * data, size_t len)
+{
+	return len == 0 || fwrite(data, 1, len, f) == len;
+}
+
+int iau_update(int in, int year, const char * output, const char * state,
+	FILE * changes, IauUpdateStats * stats)
+{
+	IauUpdateStats dummy;
+	IauReader reader;
+	IauBuf out = {NULL, 0, 0, 0};
+	IauBuf stateOut = {NULL, 0, 0, 0};
+	IauBuf geogcs = {NULL, 0, 0, 0};
+	IauAside outFile, stateFile;
+	DiffScratch diff;
+	StateBlock * blocks = NULL, * byHash = NULL;
+	NaifIndex * oldByNaif = NULL, * newByNaif = NULL;
+	size_t nBlocks = 0, nNew = 0, newCap = 0, prevSize = 0, i;
+	const char * prev = NULL;
+	void * base = MAP_FAILED;
+	struct stat st;
+	IauBody body;
+	char * line;
+	int fd, ok = 0;
+
+	if (!stats)
+		stats = &dummy;
+	memset(stats, 0, sizeof(*stats));
+	memset(&diff, 0, sizeof(diff));
+
+	/*Previous output, mapped for the copies*/
+	fd = open(output, O_RDONLY);
+	if (fd >= 0) {
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (base != MAP_FAILED) {
+				prev = base;
+				prevSize = (size_t)st.st_size;
+			}
+		}
+		close(fd);
+	}
+	if (prev)
+		blocks = load_state(state, prevSize, &nBlocks);
+	if (nBlocks) {
+		byHash = count_malloc(nBlocks * sizeof(*byHash));
+		if (!byHash)
+			goto done;
+		memcpy(byHash, blocks, nBlocks * sizeof(*byHash));
+		qsort(byHash, nBlocks, sizeof(*byHash), cmp_state_hash);
+		oldByNaif = count_malloc(nBlocks * sizeof(*oldByNaif));
+		if (!oldByNaif)
+			goto done;
+		for (i = 0; i < nBlocks; i++) {
+			oldByNaif[i].naifNum = blocks[i].naifNum;
+			oldByNaif[i].index = i;
+		}
+		qsort(oldByNaif, nBlocks, sizeof(*oldByNaif), cmp_naif);
+	}
+
+	iau_buf_printf(&stateOut, STATE_MAGIC " %d %d\n", IAUWKT_FORMAT_VERSION, year);
+	iau_buf_printf(&out, "# IAU%i WKT Codes\n", year);
+	iau_reader_init(&reader, in);
+	while ((line = iau_reader_line(&reader))) {
+		uint64_t rowHash = hash_row(line, strlen(line), year);
+		StateBlock key, * hit = NULL;
+		size_t start = out.len;
+
+		if (!iau_parse_row(line, &body))
+			continue;
+		if (nNew == newCap) {
+			NaifIndex * grown;
+			newCap = newCap ? newCap * 2 : 256;
+			grown = count_realloc(newByNaif, newCap * sizeof(*newByNaif));
+			if (!grown) {
+				iau_reader_free(&reader);
+				goto done;
+			}
+			newByNaif = grown;
+		}
+		newByNaif[nNew].naifNum = body.naifNum;
+		newByNaif[nNew].index = nNew;
+		nNew++;
+		stats->bodies++;
+		key.rowHash = rowHash;
+		if (byHash)
+			hit = bsearch(&key, byHash, nBlocks, sizeof(*byHash), cmp_state_hash);
+		/*Duplicated rows each take their own block*/
+		while (hit && hit > byHash && hit[-1].rowHash == rowHash)
+			hit--;
+		while (hit && hit < byHash + nBlocks && hit->rowHash == rowHash
+		&& (hit->used || fnv1a(FNV_OFFSET, prev + hit->offset, hit->length) != hit->blockHash))
+			hit++;
+		if (hit && hit < byHash + nBlocks && hit->rowHash == rowHash) {
+			hit->used = 1;
+			sb_append(&out, prev + hit->offset, hit->length);
+			stats->spliced++;
+		} else {
+			const NaifIndex * n = find_naif(oldByNaif, nBlocks, body.naifNum);
+			const StateBlock * old = n ? &blocks[n->index] : NULL;
+			iau_format_body(&out, &geogcs, &body, year);
+			if (!sb_ok(&out, &geogcs)
+			|| !diff_blocks(old ? prev + old->offset : NULL, old ? old->length : 0,
+				out.data + start, out.len - start, year, changes, stats, &diff)) {
+				iau_reader_free(&reader);
+				goto done;
+			}
+			stats->rebuilt++;
+		}
+		iau_buf_printf(&stateOut, "%d %016llx %lu %lu %016llx\n", body.naifNum,
+			(unsigned long long)rowHash, (unsigned long)start, (unsigned long)(out.len - start),
+			(unsigned long long)fnv1a(FNV_OFFSET, out.data + start, out.len - start));
+	}
+	if (reader.error) {
+		iau_reader_free(&reader);
+		goto done;
+	}
+	iau_reader_free(&reader);
+	if (!sb_ok(&out, &geogcs) || stateOut.error)
+		goto done;
+
+	/*Bodies no longer in the table*/
+	if (nNew)
+		qsort(newByNaif, nNew, sizeof(*newByNaif), cmp_naif);
+	for (i = 0; i < nBlocks; i++) {
+		const StateBlock * b = &blocks[oldByNaif[i].index];
+		if ((i && oldByNaif[i - 1].naifNum == b->naifNum)
+		|| find_naif(newByNaif, nNew, b->naifNum))
+			continue;
+		if (!diff_blocks(prev + b->offset, b->length, NULL, 0, year, changes, stats, &diff))
+			goto done;
+	}
+
+	/*Write both files aside, then move them in place, output first*/
+	if (!iau_aside_open(&outFile, output))
+		goto done;
+	if (!iau_aside_open(&stateFile, state)) {
+		iau_aside_close(&outFile, 0);
+		goto done;
+	}
+	ok = write_data(outFile.stream, out.data, out.len)
+		&& write_data(stateFile.stream, stateOut.data, stateOut.len)
+		&& fflush(stateFile.stream) == 0;
+	ok = iau_aside_close(&outFile, ok);
+	ok = iau_aside_close(&stateFile, ok);
+
+done:
+	if (base != MAP_FAILED)
+		munmap(base, prevSize);
+	count_free(blocks);
+	count_free(byHash);
+	count_free(oldByNaif);
+	count_free(newByNaif);
+	count_free(diff.oldLines);
+	count_free(diff.newLines);
+	iau_buf_free(&out);
+	iau_buf_free(&stateOut);
+	iau_buf_free(&geogcs);
+	return ok;
+}
+
+/*------------------------------------------------------------------------------
+ * AUTO code resolution
+ *
+ * The cached definition of an AUTO code doubles as its template: the
+ * positions of the central longitude and latitude values are located once
+ * when it is built, and a request copies the text around them with the
+ * requested numbers in their place. Codes of mapped registries are built
+ * from the body parameters stored in the map.
+ *------------------------------------------------------------------------------
+*/
+
+int iau_lookup_auto(IauLookup * lk, IauBuf * out, const char * authority, int code,
+	double lon, double lat)
+{
+	int year = authority_year(authority);
+	const Entry * e = code % 100 >= AUTO_FIRST_OFFSET ? find_entry(code % 100) : NULL;
+	const CacheSlot * s;
+	char number[32];
+	int i;
+
+	if (!year || !e || !(lon >= -360 && lon <= 360) || !(lat >= -90 && lat <= 90))
+		return 0;
+	i = cache_find(lk, year, code);
+	if (i < 0) {
+		const IauBody * body = NULL;
+		IauBody mapped;
+		int k;
+		for (k = 0; k < lk->mapCount && !body; k++)
+			if (iau_map_year(lk->maps[k]) == year && iau_map_body(lk->maps[k], code, &mapped))
+				body = &mapped;
+		for (k = 0; k < lk->registryCount && !body; k++)
+			if (lk->registries[k]->year == year)
+				body = iau_registry_find(lk->registries[k], code / 100);
+		i = body ? cache_insert(lk, year, code, body, NULL) : dict_expand_code(lk, year, code);
+		if (i < 0)
+			return 0;
+	}
+	s = &lk->slots[i];
+	if (!s->lonLen)
+		return 0;
+
+	/*The central longitude always comes before the other PARAMETERs*/
+	sb_append(out, s->wkt.data, s->lonAt);
+	sb_append(out, number, (size_t)snprintf(number, sizeof(number), "%.15g", lon));
+	if (s->latLen) {
+		sb_append(out, s->wkt.data + s->lonAt + s->lonLen, s->latAt - s->lonAt - s->lonLen);
+		sb_append(out, number, (size_t)snprintf(number, sizeof(number), "%.15g", lat));
+		sb_append(out, s->wkt.data + s->latAt + s->latLen, s->wkt.len - s->latAt - s->latLen);
+	} else {
+		sb_append(out, s->wkt.data + s->lonAt + s->lonLen, s->wkt.len - s->lonAt - s->lonLen);
+	}
+	return sb_ok(out, NULL);
+}
+
+int iau_lookup_auto_string(IauLookup * lk, IauBuf * out, const char * request)
+{
+	char authority[32];
+	const char * colon = strchr(request, ':');
+	char * end;
+	double lon, lat;
+	size_t n;
+	int code;
+
+	if (!colon)
+		return 0;
+	n = (size_t)(colon - request);
+	if (n >= sizeof(authority))
+		return 0;
+	memcpy(authority, request, n);
+	authority[n] = '\0';
+	code = (int)strtol(colon + 1, &end, 10);
+	if (*end != ',')
+		return 0;
+	lon = strtod(end + 1, &end);
+	if (*end != ',')
+		return 0;
+	lat = strtod(end + 1, &end);
+	while (*end == ' ' || *end == '\t' || *end == '\r')
+		end++;
+	if (*end)
+		return 0;
+	return iau_lookup_auto(lk, out, authority, code, lon, lat);
+}
+
+/*------------------------------------------------------------------------------
+ * Planetocentric / planetographic latitude conversion
+ *
+ * tan(ographic) = (a/b)^2 tan(ocentric), with both factors computed once per
+ * body from the double precision axes. The kernel works on LAT_LANES
+ * latitudes at a time with compiler vector types, as
+ *
+ *   result = atan2(k sin(lat), cos(lat))
+ *
+ * sin and cos are Taylor polynomials exact to 1e-18 over [-pi/2, pi/2],
+ * atan is the Cephes rational approximation on [0, 1] after folding the
+ * ratio. The reference path computes the same with libm.
+ *------------------------------------------------------------------------------
+*/
+
+#define DEG_TO_RAD 0.017453292519943295
+#define RAD_TO_DEG 57.29577951308232
+#define PIO2 1.5707963267948966
+#define PIO4 0.7853981633974483
+#define MOREBITS 6.123233995736765886130e-17
+
+const IauEllipsoid * iau_registry_ellipsoid(const IauRegistry * reg, int naifNum)
+{
+	const NaifIndex * n = find_naif(reg->byNaif, reg->count, naifNum);
+	return n ? &reg->ellipsoids[n->index] : NULL;
+}
+
+static double lat_factor(const IauEllipsoid * e, int direction)
+{
+	return direction == IAU_TO_GRAPHIC ? e->toGraphic : e->toCentric;
+}
+
+static double convert_lat_ref(double lat, double k)
+{
+	double x = lat * DEG_TO_RAD;
+	return atan2(k * sin(x), cos(x)) * RAD_TO_DEG;
+}
+
+void iau_convert_lat_ref(const IauEllipsoid * e, int direction, const double * lat, double * out, size_t n)
+{
+	double k = lat_factor(e, direction);
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		out[i] = convert_lat_ref(lat[i], k);
+}
+
+#if defined(__GNUC__)
+
+/*128 bit vectors, the baseline of x86-64 (SSE2) and of AArch64 (NEON)*/
+#define LAT_LANES 2
+
+typedef double VecD __attribute__((vector_size(LAT_LANES * sizeof(double))));
+typedef int64_t VecI __attribute__((vector_size(LAT_LANES * sizeof(double))));
+
+static inline VecD vsplat(double v)
+{
+	VecD r;
+	int i;
+	for (i = 0; i < LAT_LANES; i++)
+		r[i] = v;
+	return r;
+}
+
+/*mask ? a : b, mask lanes being all ones or all zeros*/
+static inline VecD vselect(VecI mask, VecD a, VecD b)
+{
+	return (VecD)(((VecI)a & mask) | ((VecI)b & ~mask));
+}
+
+static inline VecD vabs(VecD v)
+{
+	return (VecD)((VecI)v & ~(VecI)vsplat(-0.0));
+}
+
+/*atan of r in [0, 1]*/
+static inline VecD vatan01(VecD r)
+{
+	VecI big = r > vsplat(0.66);
+	VecD z = vselect(big, (r - vsplat(1.0)) / (r + vsplat(1.0)), r);
+	VecD base = vselect(big, vsplat(PIO4 + 0.5 * MOREBITS), vsplat(0.0));
+	VecD z2 = z * z;
+	VecD p = vsplat(-8.750608600031904122785e-1);
+	p = p * z2 + vsplat(-1.615753718733365076637e1);
+	p = p * z2 + vsplat(-7.500855792314704667340e1);
+	p = p * z2 + vsplat(-1.228866684490136173410e2);
+	p = p * z2 + vsplat(-6.485021904942025371773e1);
+	VecD q = z2 + vsplat(2.485846490142306297962e1);
+	q = q * z2 + vsplat(1.650270098316988542046e2);
+	q = q * z2 + vsplat(4.328810604912902668951e2);
+	q = q * z2 + vsplat(4.853903996359136964868e2);
+	q = q * z2 + vsplat(1.945506571482613964425e2);
+	return base + (z * (z2 * p / q) + z);
+}
+
+static inline VecD vconvert(VecD lat, VecD k)
+{
+	VecD x = lat * vsplat(DEG_TO_RAD);
+	VecD x2 = x * x;
+	VecD s = vsplat(1.0 / 51090942171709440000.0);
+	s = s * x2 - vsplat(1.0 / 121645100408832000.0);
+	s = s * x2 + vsplat(1.0 / 355687428096000.0);
+	s = s * x2 - vsplat(1.0 / 1307674368000.0);
+	s = s * x2 + vsplat(1.0 / 6227020800.0);
+	s = s * x2 - vsplat(1.0 / 39916800.0);
+	s = s * x2 + vsplat(1.0 / 362880.0);
+	s = s * x2 - vsplat(1.0 / 5040.0);
+	s = s * x2 + vsplat(1.0 / 120.0);
+	s = s * x2 - vsplat(1.0 / 6.0);
+	s = (s * x2) * x + x;
+	VecD c = vsplat(-1.0 / 1124000727777607680000.0);
+	c = c * x2 + vsplat(1.0 / 2432902008176640000.0);
+	c = c * x2 - vsplat(1.0 / 6402373705728000.0);
+	c = c * x2 + vsplat(1.0 / 20922789888000.0);
+	c = c * x2 - vsplat(1.0 / 87178291200.0);
+	c = c * x2 + vsplat(1.0 / 479001600.0);
+	c = c * x2 - vsplat(1.0 / 3628800.0);
+	c = c * x2 + vsplat(1.0 / 40320.0);
+	c = c * x2 - vsplat(1.0 / 720.0);
+	c = c * x2 + vsplat(1.0 / 24.0);
+	c = c * x2 - vsplat(0.5);
+	c = c * x2 + vsplat(1.0);
+	/*cos(+-pi/2) may round below zero*/
+	c = vselect(c < vsplat(0.0), vsplat(0.0), c);
+
+	VecD y = k * s;
+	VecD ay = vabs(y);
+	VecI small = ay <= c;
+	VecD t = vatan01(vselect(small, ay / c, c / ay));
+	VecD r = vselect(small, t, vsplat(PIO2 + MOREBITS) - t);
+	/*sign of y*/
+	r = (VecD)((VecI)r | ((VecI)y & (VecI)vsplat(-0.0)));
+	return r * vsplat(RAD_TO_DEG);
+}
+
+/*vconvert, its lanes outside [-90, 90] (or NaN) through the libm path: the
+ *series and the clamp of the cosine only hold within it*/
+static inline VecD vconvert_lat(VecD lat, VecD vk, double k)
+{
+	VecD r = vconvert(lat, vk);
+	VecI inside = vabs(lat) <= vsplat(90.0);
+	int i;
+
+	for (i = 0; i < LAT_LANES; i++)
+		if (!inside[i])
+			r[i] = convert_lat_ref(lat[i], k);
+	return r;
+}
+
+void iau_convert_lat(const IauEllipsoid * e, int direction, const double * lat, double * out, size_t n)
+{
+	double k = lat_factor(e, direction);
+	VecD vk = vsplat(k);
+	VecD v;
+	size_t i;
+
+	if (k == 1.0) {
+		/*Outside [-90, 90] the reference still wraps into (-180, 180]*/
+		for (i = 0; i < n; i++)
+			out[i] = fabs(lat[i]) <= 90.0 ? lat[i] : convert_lat_ref(lat[i], k);
+		return;
+	}
+	for (i = 0; i + LAT_LANES <= n; i += LAT_LANES) {
+		memcpy(&v, lat + i, sizeof(v));
+		v = vconvert_lat(v, vk, k);
+		memcpy(out + i, &v, sizeof(v));
+	}
+	if (i < n) {
+		/*Tail through a zero padded vector, for the same results*/
+		double pad[LAT_LANES] = {0};
+		memcpy(pad, lat + i, (n - i) * sizeof(double));
+		memcpy(&v, pad, sizeof(v));
+		v = vconvert_lat(v, vk, k);
+		memcpy(out + i, &v, (n - i) * sizeof(double));
+	}
+}
+
+#else
+
+void iau_convert_lat(const IauEllipsoid * e, int direction, const double * lat, double * out, size_t n)
+{
+	iau_convert_lat_ref(e, direction, lat, out, n);
+}
+
+#endif
+
+/*------------------------------------------------------------------------------
+ * Dictionary encoded tables
+ *
+ * Every definition of a body repeats its GEOGCS, and every body repeats
+ * the catalog text of each projection. A dictionary file holds each once:
+ *
+ *   #IAUWKT-DICT <version> <year>
+ *   T	<offset>	<comment template>	<WKT template>	per catalog entry
+ *   B	<naifNum>	<target>	<GEOGCS>		per body, in input order
+ *
+ * Templates hold $T (target), $G (GEOGCS), $Y (year) and $C (code) in place
+ * of the body parts, and each body has the codes NaifNum * 100 + offset of
+ * every template. Opening a dictionary only indexes its lines, a definition
+ * is expanded when asked for. Expanding every body gives back the
+ * iau_format_body file.
+ *------------------------------------------------------------------------------
+*/
+
+#define DICT_MAGIC "#IAUWKT-DICT"
+#define DICT_VERSION 1
+#define DICT_MAX_OFFSET 100
+
+void iau_format_dict_header(IauBuf * out, int year)
+{
+	IauBuf geogcs = {(char *)"$G", 2, 0, 0};
+	int i;
+
+	sb_puts(out, DICT_MAGIC " ");
+	sb_putint(out, DICT_VERSION);
+	sb_puts(out, " ");
+	sb_putint(out, year);
+	sb_puts(out, "\n");
+	for (i = 0; i < ENTRY_COUNT; i++) {
+		sb_puts(out, "T\t");
+		sb_putint(out, entries[i].offset);
+		sb_puts(out, "\t");
+		append_comment(out, &entries[i], "$T");
+		if (!out->error)
+			out->len--;	/*newline*/
+		sb_puts(out, "\t");
+		append_wkt_text(out, &entries[i], "$T", "$C", "$Y", &geogcs);
+		sb_puts(out, "\n");
+	}
+}
+
+void iau_format_body_dict(IauBuf * out, IauBuf * geogcs, const IauBody * body, int year)
+{
+	iau_format_geogcs(geogcs, body, year);
+	sb_puts(out, "B\t");
+	sb_putint(out, body->naifNum);
+	sb_puts(out, "\t");
+	sb_puts(out, body->target);
+	sb_puts(out, "\t");
+	sb_append(out, geogcs->data, geogcs->len);
+	sb_puts(out, "\n");
+	sb_ok(out, geogcs);
+}
+
+/*Write out the line buffer of dw*/
+static int dict_writer_put(IauDictWriter * dw)
+{
+	if (dw->line.error || !write_data(dw->stream, dw->line.data, dw->line.len))
+		dw->error = 1;
+	else
+		dw->written += dw->line.len;
+	dw->line.len = 0;
+	return !dw->error;
+}
+
+int iau_dict_writer_init(IauDictWriter * dw, FILE * stream, int year)
+{
+	memset(dw, 0, sizeof(*dw));
+	dw->stream = stream;
+	dw->year = year;
+	iau_format_dict_header(&dw->line, year);
+	if (!dict_writer_put(dw)) {
+		iau_buf_free(&dw->line);
+		return 0;
+	}
+	return 1;
+}
+
+int iau_dict_writer_open(IauDictWriter * dw, const char * path, int year)
+{
+	IauAside file;
+
+	/*Lookups keep the previous file mapped*/
+	if (!iau_aside_open(&file, path))
+		return 0;
+	if (!iau_dict_writer_init(dw, file.stream, year)) {
+		iau_aside_close(&file, 0);
+		return 0;
+	}
+	dw->file = file;
+	return 1;
+}
+
+int iau_dict_writer_add(IauDictWriter * dw, const IauBody * body)
+{
+	if (dw->error)
+		return 0;
+	iau_format_body_dict(&dw->line, &dw->geogcs, body, dw->year);
+	return dict_writer_put(dw);
+}
+
+int iau_dict_writer_close(IauDictWriter * dw, int ok)
+{
+	ok = ok && !dw->error;
+	if (dw->file.stream)
+		ok = iau_aside_close(&dw->file, ok);
+	else if (fflush(dw->stream) != 0)
+		ok = 0;
+	iau_buf_free(&dw->line);
+	iau_buf_free(&dw->geogcs);
+	return ok;
+}
+
+typedef struct {
+	const char * text;
+	size_t len;
+} DictText;
+
+typedef struct {
+	int offset;
+	DictText comment, wkt;
+} DictTemplate;
+
+typedef struct {
+	int naifNum;
+	DictText target, geogcs;
+} DictBody;
+
+struct IauDict {
+	void * base;
+	size_t size;
+	int year;
+	char yearText[16];
+	DictTemplate * templates;	/*In file order*/
+	size_t templateCount;
+	int byOffset[DICT_MAX_OFFSET];	/*Template index, -1 if none*/
+	DictBody * bodies;		/*In file order*/
+	size_t bodyCount;
+	NaifIndex * byNaif;
+};
+
+/*Split a line at tabs into up to n fields, returns the field count*/
+static int dict_fields(const char * line, const char * end, DictText * fields, int n)
+{
+	int count = 0;
+
+	while (count < n) {
+		const char * tab = memchr(line, '\t', end - line);
+		fields[count].text = line;
+		fields[count].len = (tab ? tab : end) - line;
+		count++;
+		if (!tab)
+			break;
+		line = tab + 1;
+	}
+	return count;
+}
+
+IauDict * iau_dict_open(const char * path)
+{
+	struct stat st;
+	IauDict * d;
+	const char * p, * end;
+	size_t bodyCap = 0, templateCap = 0, i;
+	int fd, version;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(DICT_MAGIC)) {
+		close(fd);
+		return NULL;
+	}
+	d = count_calloc(1, sizeof(*d));
+	if (!d) {
+		close(fd);
+		return NULL;
+	}
+	d->size = (size_t)st.st_size;
+	d->base = mmap(NULL, d->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (d->base == MAP_FAILED) {
+		count_free(d);
+		return NULL;
+	}
+	p = d->base;
+	end = p + d->size;
+	if (memcmp(p, DICT_MAGIC " ", sizeof(DICT_MAGIC)) != 0
+	|| sscanf(p + sizeof(DICT_MAGIC), "%d %d", &version, &d->year) != 2
+	|| version != DICT_VERSION || d->year <= 0)
+		goto fail;
+	format_int(d->yearText, d->year);
+	for (i = 0; i < DICT_MAX_OFFSET; i++)
+		d->byOffset[i] = -1;
+
+	while (p < end) {
+		const char * eol = memchr(p, '\n', end - p);
+		DictText f[4];
+		int n;
+		if (!eol)
+			eol = end;
+		n = dict_fields(p, eol, f, 4);
+		if (n == 4 && f[0].len == 1 && f[0].text[0] == 'T') {
+			int offset = atoi(f[1].text);
+			if (offset < 0 || offset >= DICT_MAX_OFFSET)
+				goto fail;
+			if (d->templateCount == templateCap) {
+				DictTemplate * grown;
+				templateCap = templateCap ? templateCap * 2 : 64;
+				grown = count_realloc(d->templates, templateCap * sizeof(*grown));
+				if (!grown)
+					goto fail;
+				d->templates = grown;
+			}
+			d->byOffset[offset] = (int)d->templateCount;
+			d->templates[d->templateCount].offset = offset;
+			d->templates[d->templateCount].comment = f[2];
+			d->templates[d->templateCount].wkt = f[3];
+			d->templateCount++;
+		} else if (n == 4 && f[0].len == 1 && f[0].text[0] == 'B') {
+			if (d->bodyCount == bodyCap) {
+				DictBody * grown;
+				bodyCap = bodyCap ? bodyCap * 2 : 256;
+				grown = count_realloc(d->bodies, bodyCap * sizeof(*grown));
+				if (!grown)
+					goto fail;
+				d->bodies = grown;
+			}
+			d->bodies[d->bodyCount].naifNum = atoi(f[1].text);
+			d->bodies[d->bodyCount].target = f[2];
+			d->bodies[d->bodyCount].geogcs = f[3];
+			d->bodyCount++;
+		}
+		p = eol + 1;
+	}
+
+	d->byNaif = count_malloc((d->bodyCount ? d->bodyCount : 1) * sizeof(NaifIndex));
+	if (!d->byNaif)
+		goto fail;
+	for (i = 0; i < d->bodyCount; i++) {
+		d->byNaif[i].naifNum = d->bodies[i].naifNum;
+		d->byNaif[i].index = i;
+	}
+	qsort(d->byNaif, d->bodyCount, sizeof(NaifIndex), cmp_naif);
+	return d;
+
+fail:
+	iau_dict_close(d);
+	return NULL;
+}
+
+void iau_dict_close(IauDict * d)
+{
+	if (!d)
+		return;
+	munmap(d->base, d->size);
+	count_free(d->templates);
+	count_free(d->bodies);
+	count_free(d->byNaif);
+	count_free(d);
+}
+
+int iau_dict_year(const IauDict * d)
+{
+	return d->year;
+}
+
+size_t iau_dict_count(const IauDict * d)
+{
+	return d->bodyCount;
+}
+
+/*Append a template with the parts of body b*/
+static void dict_expand(IauBuf * out, const DictText * t, const IauDict * d, const DictBody * b, const char * code)
+{
+	const char * p = t->text, * end = t->text + t->len;
+
+	while (p < end) {
+		const char * dollar = memchr(p, '$', end - p);
+		if (!dollar || dollar + 1 == end) {
+			sb_append(out, p, end - p);
+			break;
+		}
+		sb_append(out, p, dollar - p);
+		switch (dollar[1]) {
+		case 'T':
+			sb_append(out, b->target.text, b->target.len);
+			break;
+		case 'G':
+			sb_append(out, b->geogcs.text, b->geogcs.len);
+			break;
+		case 'Y':
+			sb_puts(out, d->yearText);
+			break;
+		case 'C':
+			sb_puts(out, code);
+			break;
+		default:
+			sb_append(out, dollar, 2);
+		}
+		p = dollar + 2;
+	}
+}
+
+int iau_dict_find(const IauDict * d, IauBuf * out, int code)
+{
+	const NaifIndex * n = find_naif(d->byNaif, d->bodyCount, code / 100);
+	int offset = code % 100;
+	char text[16];
+
+	if (!n || offset < 0 || d->byOffset[offset] < 0)
+		return 0;
+	format_int(text, code);
+	dict_expand(out, &d->templates[d->byOffset[offset]].wkt, d, &d->bodies[n->index], text);
+	return sb_ok(out, NULL);
+}
+
+void iau_dict_expand_body(const IauDict * d, IauBuf * out, size_t i)
+{
+	const DictBody * b = &d->bodies[i];
+	char text[16];
+	size_t k;
+
+	sb_puts(out, "# IAU");
+	sb_puts(out, d->yearText);
+	sb_puts(out, " WKT Codes for ");
+	sb_append(out, b->target.text, b->target.len);
+	sb_puts(out, "\n");
+	for (k = 0; k < d->templateCount; k++) {
+		const DictTemplate * t = &d->templates[k];
+		size_t len = format_int(text, b->naifNum * 100 + t->offset);
+		dict_expand(out, &t->comment, d, b, text);
+		sb_puts(out, "\n");
+		sb_append(out, text, len);
+		sb_puts(out, ",");
+		dict_expand(out, &t->wkt, d, b, text);
+		sb_puts(out, "\n");
+	}
+}
+
+/*------------------------------------------------------------------------------
+ * Run statistics
+ *------------------------------------------------------------------------------
+*/
+
+static const char * const rowStatusNames[IAU_ROW_STATUS_COUNT] = {
+	"ok", "short", "naif_id", "mean_radius", "radii"
+};
+
+static const char * const stageNames[IAU_STAGE_COUNT] = {
+	"parse", "format", "write"
+};
+
+void iau_registry_stats(const IauRegistry * reg, IauStats * stats)
+{
+	int k;
+
+	for (k = 0; k < IAU_ROW_STATUS_COUNT; k++)
+		stats->rows[k] += reg->rows[k];
+}
+
+static size_t rows_read(const IauStats * stats)
+{
+	size_t n = 0;
+	int k;
+
+	for (k = 0; k < IAU_ROW_STATUS_COUNT; k++)
+		n += stats->rows[k];
+	return n;
+}
+
+/*Catalog entries of family f, each written once per body*/
+static int family_codes(int f)
+{
+	int i, n = 0;
+
+	for (i = 0; i < ENTRY_COUNT; i++)
+		n += entries[i].family == f;
+	return n;
+}
+
+void iau_stats_print(FILE * f, const IauStats * stats)
+{
+	int k;
+
+	fprintf(f, "rows      %lu read, %lu bodies\n",
+		(unsigned long)rows_read(stats), (unsigned long)stats->rows[IAU_ROW_OK]);
+	fprintf(f, "skipped  ");
+	for (k = IAU_ROW_OK + 1; k < IAU_ROW_STATUS_COUNT; k++)
+		fprintf(f, " %s %lu", rowStatusNames[k], (unsigned long)stats->rows[k]);
+	fprintf(f, "\n");
+	fprintf(f, "written   %lu bodies, %lu triaxial with their mean radius\n",
+		(unsigned long)stats->bodies, (unsigned long)stats->triaxial);
+	fprintf(f, "codes     %lu\n", (unsigned long)(stats->bodies * ENTRY_COUNT));
+	for (k = 0; k < FAM_COUNT; k++)
+		fprintf(f, "  %-36s %lu\n", families[k].label,
+			(unsigned long)(stats->bodies * family_codes(k)));
+	fprintf(f, "bytes     %lu\n", (unsigned long)stats->bytes);
+	fprintf(f, "time     ");
+	for (k = 0; k < IAU_STAGE_COUNT; k++)
+		fprintf(f, " %s %.2f ms", stageNames[k], stats->seconds[k] * 1e3);
+	fprintf(f, "\n");
+	fprintf(f, "heap      %lu allocations, %lu reallocations, %lu frees\n",
+		(unsigned long)stats->allocations, (unsigned long)stats->reallocations,
+		(unsigned long)stats->frees);
+}
+
+void iau_stats_json(FILE * f, const IauStats * stats)
+{
+	int k;
+
+	fprintf(f, "{\n\t\"rows\": {\"read\": %lu", (unsigned long)rows_read(stats));
+	for (k = 0; k < IAU_ROW_STATUS_COUNT; k++)
+		fprintf(f, ", \"%s\": %lu", rowStatusNames[k], (unsigned long)stats->rows[k]);
+	fprintf(f, "},\n");
+	fprintf(f, "\t\"bodies\": %lu,\n", (unsigned long)stats->bodies);
+	fprintf(f, "\t\"triaxial\": %lu,\n", (unsigned long)stats->triaxial);
+	fprintf(f, "\t\"codes\": {\"total\": %lu", (unsigned long)(stats->bodies * ENTRY_COUNT));
+	for (k = 0; k < FAM_COUNT; k++)
+		fprintf(f, ", \"%s\": %lu", families[k].label,
+			(unsigned long)(stats->bodies * family_codes(k)));
+	fprintf(f, "},\n");
+	fprintf(f, "\t\"bytes\": %lu,\n", (unsigned long)stats->bytes);
+	fprintf(f, "\t\"seconds\": {");
+	for (k = 0; k < IAU_STAGE_COUNT; k++)
+		fprintf(f, "%s\"%s\": %.6f", k ? ", " : "", stageNames[k], stats->seconds[k]);
+	fprintf(f, "},\n");
+	fprintf(f, "\t\"heap\": {\"allocations\": %lu, \"reallocations\": %lu, \"frees\": %lu}\n}\n",
+		(unsigned long)stats->allocations, (unsigned long)stats->reallocations,
+		(unsigned long)stats->frees);
+}
@@ -0,0 +1,429 @@
+#ifndef IAUWKT_H
+#define IAUWKT_H
+
+#include<stdio.h>
+#include<stddef.h>
+
+/*------------------------------------------------------------------------------
+ *  iauwkt: IAU2000/2009 WKT definitions for planetary bodies
+ *
+ *  Every body of a NAIF radii table gets the codes NaifNum * 100 + offset,
+ *  offset being 0,1 (GEOGCS), 10..29 (static projections) and 60..83
+ *  (AUTO projections). Even offsets are ocentric, odd offsets ographic.
+ *
+ *  The generator side formats whole code blocks for a body as rows stream
+ *  in; the lookup side loads tables once and builds a single definition
+ *  on request, keeping recently built strings in an LRU cache.
+ *------------------------------------------------------------------------------
+*/
+
+/*Bump whenever the output of any writer changes, so that incremental
+ *runs rebuild every body*/
+#define IAUWKT_FORMAT_VERSION 1
+
+/*Growable output buffer, zero initialise before first use.
+ *
+ *The library never exits on a failed allocation: the buffer gets its error
+ *flag, later appends to it are dropped, and the functions writing to it
+ *return 0 (or NULL). The void formatters only set the flag, check it after
+ *them. iau_buf_free clears it*/
+typedef struct {
+	char * data;
+	size_t len;
+	size_t cap;
+	int error;		/*Set once growing failed, content incomplete*/
+} IauBuf;
+
+/*Append printf style formatted text*/
+void iau_buf_printf(IauBuf * buf, const char * fmt, ...);
+void iau_buf_free(IauBuf * buf);
+
+typedef struct {
+	int naifNum;
+	const char * target;	/*Body name*/
+	double mean;		/*Radii from the input table, in meters*/
+	double a, b, c;
+	float theA;		/*Semimajor axis written to the WKT1 SPHEROID*/
+	float flattening;	/*Flattening (inverse if tiny) written to the WKT1 SPHEROID*/
+	double semiMajor;	/*Ellipsoid axes for PROJ.4, WKT2 and PROJJSON,*/
+	double semiMinor;	/*the mean radius for triaxial bodies*/
+} IauBody;
+
+/*Codes per body, and the offset and projection label ("Sinusoidal AUTO")
+ *of the i-th one in output order*/
+int iau_catalog_size(void);
+int iau_catalog_offset(int i);
+const char * iau_catalog_label(int i);
+
+/*Grab the year from a table name such as naifcodes_radii_m_wAsteroids_IAU2000.csv,
+ *returns 0 if there is none*/
+int iau_year_from_filename(const char * path);
+
+/*Parse one table line in place into body, target then points into line.
+ *Returns 0 for the header and for bodies without radii*/
+int iau_parse_row(char * line, IauBody * body);
+
+/*Outcome of a table line, the reason it was skipped if not IAU_ROW_OK*/
+enum {
+	IAU_ROW_OK,
+	IAU_ROW_SHORT,		/*Fewer than the 6 columns*/
+	IAU_ROW_NAIF_ID,	/*NAIF id zero or not a number, as in the header*/
+	IAU_ROW_MEAN,		/*Mean radius empty or zero*/
+	IAU_ROW_RADII,		/*An axis is not a number*/
+	IAU_ROW_STATUS_COUNT
+};
+
+/*Same as iau_parse_row, returning the outcome of the line*/
+int iau_parse_row_status(char * line, IauBody * body);
+
+/*1 if the axes of body are too far apart for an ellipsoid, every
+ *definition then uses its mean radius*/
+int iau_body_triaxial(const IauBody * body);
+
+/*Append the full "# ..." commented code block of a body to out*/
+void iau_format_body(IauBuf * out, IauBuf * geogcs, const IauBody * body, int year);
+
+/*Append the WKT of code NaifNum * 100 + offset to out.
+ *Returns 0 if offset is not in the projection catalog or out of memory*/
+int iau_format_code(IauBuf * out, IauBuf * geogcs, const IauBody * body, int year, int offset);
+
+/*Format the GEOGCS fragment of body into geogcs (replacing its content),
+ *then iau_format_wkt builds any code of that body from it*/
+void iau_format_geogcs(IauBuf * geogcs, const IauBody * body, int year);
+int iau_format_wkt(IauBuf * out, const IauBuf * geogcs, const IauBody * body, int year, int offset);
+
+/*Append the PROJ.4 code block of a body to out, in PROJ init file
+ *("epsg" file) style: "<code> +proj=... <>" lines with their comments*/
+void iau_format_body_proj4(IauBuf * out, IauBuf * ellps, const IauBody * body);
+
+/*Append the "+proj=..." string of code NaifNum * 100 + offset to out.
+ *Returns 0 if offset is not in the projection catalog*/
+int iau_format_code_proj4(IauBuf * out, IauBuf * ellps, const IauBody * body, int offset);
+
+/*Append the ISO 19162:2019 (WKT2) code block of a body to out, laid out as
+ *the WKT1 one. datum is a scratch buffer for the body part of the CRS*/
+void iau_format_body_wkt2(IauBuf * out, IauBuf * datum, const IauBody * body, int year);
+int iau_format_code_wkt2(IauBuf * out, IauBuf * datum, const IauBody * body, int year, int offset);
+
+/*Append the PROJJSON objects of a body to out, one per line*/
+void iau_format_body_projjson(IauBuf * out, IauBuf * datum, const IauBody * body, int year);
+int iau_format_code_projjson(IauBuf * out, IauBuf * datum, const IauBody * body, int year, int offset);
+
+/*------------------------------------------------------------------------------
+ * Streaming I/O on file descriptors, for pipelines
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct {
+	int fd;
+	char * data;
+	size_t cap, start, end;
+	int eof;
+	int error;
+} IauReader;
+
+void iau_reader_init(IauReader * r, int fd);
+void iau_reader_free(IauReader * r);
+
+/*Next line without its newline, NUL terminated in the reader buffer and
+ *valid until the next call. NULL at end of input, error is then set if
+ *reading failed*/
+char * iau_reader_line(IauReader * r);
+
+/*1 if the next iau_reader_line call would wait for input*/
+int iau_reader_would_block(const IauReader * r);
+
+typedef struct {
+	int fd;
+	IauBuf buf;		/*Append output here, then call iau_writer_commit*/
+	size_t flushSize;
+	size_t written;		/*Bytes written out so far*/
+	int error;
+} IauWriter;
+
+void iau_writer_init(IauWriter * w, int fd, size_t flushSize);
+
+/*Write buf out once it holds flushSize bytes. Returns 0 after a write error,
+ *or once buf failed to grow*/
+int iau_writer_commit(IauWriter * w);
+
+/*Write buf out now. Returns 0 after a write error*/
+int iau_writer_flush(IauWriter * w);
+
+/*Flush and release the buffer, the descriptor is left open*/
+int iau_writer_close(IauWriter * w);
+
+/*------------------------------------------------------------------------------
+ * Files replaced atomically: written to path.tmp, then renamed over path, so
+ * that readers of the previous file, mmap'ed ones included, never see it
+ * truncated or half written
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct {
+	FILE * stream;		/*Write the new content here*/
+	IauBuf tmp;		/*path.tmp*/
+	const char * path;
+} IauAside;
+
+/*Create path.tmp. Returns 0 on error*/
+int iau_aside_open(IauAside * a, const char * path);
+
+/*Close the stream, then rename it over path if ok, remove it otherwise.
+ *Returns 0 if ok was 0 or on error, errno telling which*/
+int iau_aside_close(IauAside * a, int ok);
+
+/*------------------------------------------------------------------------------
+ * Body registry: one radii table loaded in memory, indexed by NAIF id
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct IauRegistry IauRegistry;
+
+/*Load a NAIF radii table, year 0 takes it from the file name. NULL on error*/
+IauRegistry * iau_registry_load(const char * path, int year);
+/*Load a NAIF radii table from an open stream, left open. NULL on error*/
+IauRegistry * iau_registry_read(FILE * stream, int year);
+void iau_registry_free(IauRegistry * reg);
+int iau_registry_year(const IauRegistry * reg);
+size_t iau_registry_count(const IauRegistry * reg);
+const IauBody * iau_registry_body(const IauRegistry * reg, size_t i);
+const IauBody * iau_registry_find(const IauRegistry * reg, int naifNum);
+
+/*------------------------------------------------------------------------------
+ * Planetocentric / planetographic latitude conversion of a registry body
+ *------------------------------------------------------------------------------
+*/
+
+enum {
+	IAU_TO_GRAPHIC,		/*Ocentric (even codes) to ographic (odd codes)*/
+	IAU_TO_CENTRIC
+};
+
+typedef struct {
+	int naifNum;
+	double a, b;		/*semiMajor and semiMinor of the body*/
+	double toGraphic;	/*(a/b)^2, tan(ographic) = toGraphic * tan(ocentric)*/
+	double toCentric;	/*(b/a)^2*/
+} IauEllipsoid;
+
+/*Compute the conversion constants of body*/
+void iau_ellipsoid_init(IauEllipsoid * e, const IauBody * body);
+
+/*Conversion constants of a body, computed when the table is loaded.
+ *NULL if naifNum is not in reg*/
+const IauEllipsoid * iau_registry_ellipsoid(const IauRegistry * reg, int naifNum);
+
+/*Largest difference in degree between iau_convert_lat and
+ *iau_convert_lat_ref*/
+#define IAU_LAT_TOLERANCE 1e-12
+
+/*Convert n latitudes in degrees from lat to out (which may be lat).
+ *Longitudes are the same in both systems, east positive as in the WKT.
+ *Vectorized over [-90, 90], within IAU_LAT_TOLERANCE of
+ *iau_convert_lat_ref; latitudes outside it go through the libm path*/
+void iau_convert_lat(const IauEllipsoid * e, int direction, const double * lat, double * out, size_t n);
+
+/*Scalar libm implementation, for validation*/
+void iau_convert_lat_ref(const IauEllipsoid * e, int direction, const double * lat, double * out, size_t n);
+
+/*------------------------------------------------------------------------------
+ * Parallel generation of whole tables
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct {
+	const IauRegistry * reg;
+	FILE * wkt;		/*Code blocks as iau_format_body, NULL to skip*/
+	FILE * proj4;		/*PROJ.4 blocks as iau_format_body_proj4, NULL to skip*/
+	FILE * wkt2;		/*WKT2 blocks as iau_format_body_wkt2, NULL to skip*/
+	FILE * projjson;	/*PROJJSON lines as iau_format_body_projjson, NULL to skip*/
+	FILE * dict;		/*Dictionary lines as iau_format_body_dict, NULL to skip.
+				 *The stream of an IauDictWriter, header written*/
+} IauBatch;
+
+/*Write every body of each batch, formatted by nThreads workers. Output
+ *goes out in input order, byte-identical to a serial run. Returns 0 if a
+ *write failed*/
+int iau_write_batches(const IauBatch * batches, int nBatches, int nThreads);
+
+/*------------------------------------------------------------------------------
+ * Run statistics of the generator
+ *------------------------------------------------------------------------------
+*/
+
+enum {
+	IAU_STAGE_PARSE,	/*Reading and parsing table rows*/
+	IAU_STAGE_FORMAT,	/*Building definitions*/
+	IAU_STAGE_WRITE,	/*Writing them out*/
+	IAU_STAGE_COUNT
+};
+
+/*Zero initialise, then add runs to it*/
+typedef struct {
+	size_t rows[IAU_ROW_STATUS_COUNT];	/*Table rows by outcome*/
+	size_t bodies;		/*Bodies written*/
+	size_t triaxial;	/*Of which written with their mean radius*/
+	size_t bytes;		/*Written to all outputs*/
+	double seconds[IAU_STAGE_COUNT];	/*Wall time*/
+	size_t allocations, reallocations, frees;	/*Heap calls of the library*/
+} IauStats;
+
+/*Heap calls made by the library so far, from all threads. A run's counts
+ *are the difference between two calls*/
+void iau_heap_counts(size_t * allocations, size_t * reallocations, size_t * frees);
+
+/*Add the row outcomes of the table reg was loaded from to stats*/
+void iau_registry_stats(const IauRegistry * reg, IauStats * stats);
+
+/*Same as iau_write_batches, adding the bodies written, bytes and stage
+ *times to stats. Format time is the run time not spent writing*/
+int iau_write_batches_stats(const IauBatch * batches, int nBatches, int nThreads, IauStats * stats);
+
+/*Print stats as text, codes are reported per projection family*/
+void iau_stats_print(FILE * f, const IauStats * stats);
+
+/*Same as iau_stats_print as a JSON object*/
+void iau_stats_json(FILE * f, const IauStats * stats);
+
+/*------------------------------------------------------------------------------
+ * Incremental regeneration of a WKT file
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct {
+	size_t bodies;		/*Bodies in the table*/
+	size_t spliced;		/*Blocks copied from the previous output*/
+	size_t rebuilt;		/*Blocks formatted again*/
+	size_t codesAdded, codesChanged, codesRemoved;
+} IauUpdateStats;
+
+/*Write the WKT file of the table read from fd in to output, as iau2wkt
+ *does, copying the blocks of bodies whose row is unchanged since the run
+ *that wrote the state file, then replace output and state. Codes whose
+ *definition differs from the previous output are listed to changes (if not
+ *NULL) as "IAU2000:49915 changed" lines (added, changed or removed).
+ *Returns 0 on error*/
+int iau_update(int in, int year, const char * output, const char * state,
+	FILE * changes, IauUpdateStats * stats);
+
+/*------------------------------------------------------------------------------
+ * Prebuilt code registry: every definition of a table written once to a
+ * binary file, then mmap'ed read-only and shared by reader processes
+ *------------------------------------------------------------------------------
+*/
+
+typedef struct IauMap IauMap;
+
+/*Write the registry file of reg. Returns 0 on error*/
+int iau_registry_write_map(const IauRegistry * reg, const char * path);
+
+/*Map a registry file, NULL if it can't be opened or is not one*/
+IauMap * iau_map_open(const char * path);
+void iau_map_close(IauMap * map);
+int iau_map_year(const IauMap * map);
+
+/*WKT of code, NULL if absent. len, if not NULL, receives its length*/
+const char * iau_map_find(const IauMap * map, int code, size_t * len);
+
+/*Fill body with the parameters of the body owning code, target points into
+ *the mapping. Returns 0 if code is absent*/
+int iau_map_body(const IauMap * map, int code, IauBody * body);
+
+/*------------------------------------------------------------------------------
+ * Dictionary encoded tables: each body's GEOGCS and each catalog entry's
+ * projection template stored once, definitions expanded on demand
+ *------------------------------------------------------------------------------
+*/
+
+/*Append the first lines of a dictionary file, holding the templates*/
+void iau_format_dict_header(IauBuf * out, int year);
+
+/*Append the dictionary line of a body, geogcs is a scratch buffer*/
+void iau_format_body_dict(IauBuf * out, IauBuf * geogcs, const IauBody * body, int year);
+
+/*A dictionary file being written: its header, then one line per body*/
+typedef struct {
+	IauAside file;
+	FILE * stream;		/*Lines go here, file.stream unless given*/
+	IauBuf line;
+	IauBuf geogcs;
+	int year;
+	size_t written;		/*Bytes written out so far*/
+	int error;
+} IauDictWriter;
+
+/*Start a dictionary file written aside, moved over path once closed.
+ *Returns 0 on error, with nothing left to close*/
+int iau_dict_writer_open(IauDictWriter * dw, const char * path, int year);
+
+/*Start a dictionary on an open stream, left open. Returns 0 on error, with
+ *nothing left to close*/
+int iau_dict_writer_init(IauDictWriter * dw, FILE * stream, int year);
+
+/*Append the line of body. Returns 0 after an error*/
+int iau_dict_writer_add(IauDictWriter * dw, const IauBody * body);
+
+/*Flush, then move the file over its path if ok and nothing failed, remove
+ *it otherwise. Returns 0 if the dictionary was not written*/
+int iau_dict_writer_close(IauDictWriter * dw, int ok);
+
+typedef struct IauDict IauDict;
+
+/*Map a dictionary file, NULL if it can't be opened or is not one*/
+IauDict * iau_dict_open(const char * path);
+void iau_dict_close(IauDict * d);
+int iau_dict_year(const IauDict * d);
+size_t iau_dict_count(const IauDict * d);
+
+/*Append the WKT of code to out. Returns 0 if code is absent or out of memory*/
+int iau_dict_find(const IauDict * d, IauBuf * out, int code);
+
+/*Append the i-th body's code block, as iau_format_body would*/
+void iau_dict_expand_body(const IauDict * d, IauBuf * out, size_t i);
+
+/*------------------------------------------------------------------------------
+ * On-demand lookup of "IAU2000:49915" style codes
+ *------------------------------------------------------------------------------
+*/
+
+/*Not thread safe: every call, cache hits included, updates the LRU list,
+ *and the strings returned live in its slots. Give each thread its own
+ *IauLookup; mapped registry and dictionary files opened once per thread
+ *still share their pages. A returned string is only valid on the thread
+ *that asked for it*/
+typedef struct IauLookup IauLookup;
+
+IauLookup * iau_lookup_new(size_t cacheSize);
+void iau_lookup_free(IauLookup * lk);
+
+/*Hand a registry over to the lookup, which frees it. Returns 0 on error*/
+int iau_lookup_add(IauLookup * lk, IauRegistry * reg);
+
+/*Hand a mapped registry over to the lookup, which closes it. Returns 0 on error*/
+int iau_lookup_add_map(IauLookup * lk, IauMap * map);
+
+/*Hand a dictionary over to the lookup, which closes it. Returns 0 on error*/
+int iau_lookup_add_dict(IauLookup * lk, IauDict * d);
+
+/*Return the WKT of code for authority ("IAU2000"), or NULL if unknown or
+ *out of memory.
+ *The string stays valid until it is evicted from the cache, that is for
+ *at least the next cacheSize - 1 lookups*/
+const char * iau_lookup(IauLookup * lk, const char * authority, int code);
+
+/*Same as iau_lookup for a single "IAU2000:49915" string*/
+const char * iau_lookup_string(IauLookup * lk, const char * request);
+
+/*Append to out the WKT of AUTO code (offsets 60 and up) centered on lon,
+ *lat: the central longitude and, for the projections that have one, the
+ *latitude of origin or standard parallel take the requested values.
+ *Returns 0 if the code is unknown, not an AUTO code, lon, lat are out
+ *of range or memory ran out. Definitions are built once and then only spliced*/
+int iau_lookup_auto(IauLookup * lk, IauBuf * out, const char * authority, int code,
+	double lon, double lat);
+
+/*Same as iau_lookup_auto for a single "IAU2000:49962,lon,lat" string*/
+int iau_lookup_auto_string(IauLookup * lk, IauBuf * out, const char * request);
+
+#endif